@@ -2,6 +2,47 @@
 #include <stdlib.h>
 #include <string.h>
 
+// ------------------------------
+// Arena: bloco contíguo de onde salas e pistas são tiradas em
+// sequência; tudo é liberado com um único free no final.
+// ------------------------------
+typedef struct Arena {
+    unsigned char* dados;
+    size_t usado;
+    size_t capacidade;
+} Arena;
+
+// ------------------------------
+// Função: criarArena
+// Reserva um bloco com a capacidade pedida (em bytes)
+// ------------------------------
+Arena criarArena(size_t capacidade) {
+    Arena a;
+    a.dados = (unsigned char*) malloc(capacidade);
+    if (!a.dados) {
+        printf("Erro ao alocar memória!\n");
+        exit(1);
+    }
+    a.usado = 0;
+    a.capacidade = capacidade;
+    return a;
+}
+
+// ------------------------------
+// Função: alocarNaArena
+// Devolve o próximo pedaço livre do bloco (alinhado em 16 bytes)
+// ------------------------------
+void* alocarNaArena(Arena* a, size_t tamanho) {
+    size_t pedido = (tamanho + 15) & ~(size_t) 15;
+    if (a->capacidade - a->usado < pedido) {
+        printf("Arena sem espaço!\n");
+        exit(1);
+    }
+    void* p = a->dados + a->usado;
+    a->usado += pedido;
+    return p;
+}
+
 // ------------------------------
 // Estrutura da Mansão (Árvore Binária)
 // ------------------------------
@@ -13,24 +54,21 @@ typedef struct Sala {
 } Sala;
 
 // ------------------------------
-// Estrutura da Árvore de Pistas (BST)
+// Estrutura da Árvore de Pistas (BST balanceada – AVL)
 // ------------------------------
 typedef struct PistaNode {
     char pista[100];
     struct PistaNode* esquerda;
     struct PistaNode* direita;
+    int altura;  // folha = 1
 } PistaNode;
 
 // ------------------------------
 // Função: criarSala
-// Cria dinamicamente uma sala da mansão com ou sem pista
+// Cria uma sala da mansão (com ou sem pista) dentro da arena
 // ------------------------------
-Sala* criarSala(const char* nome, const char* pista) {
-    Sala* novaSala = (Sala*) malloc(sizeof(Sala));
-    if (!novaSala) {
-        printf("Erro ao alocar memória!\n");
-        exit(1);
-    }
+Sala* criarSala(Arena* arena, const char* nome, const char* pista) {
+    Sala* novaSala = (Sala*) alocarNaArena(arena, sizeof(Sala));
     strcpy(novaSala->nome, nome);
     if (pista != NULL)
         strcpy(novaSala->pista, pista);
@@ -43,34 +81,81 @@ Sala* criarSala(const char* nome, const char* pista) {
 
 // ------------------------------
 // Função: criarPistaNode
-// Cria um nó para a árvore de pistas
+// Cria um nó para a árvore de pistas dentro da arena
 // ------------------------------
-PistaNode* criarPistaNode(const char* pista) {
-    PistaNode* novo = (PistaNode*) malloc(sizeof(PistaNode));
-    if (!novo) {
-        printf("Erro ao alocar memória!\n");
-        exit(1);
-    }
+PistaNode* criarPistaNode(Arena* arena, const char* pista) {
+    PistaNode* novo = (PistaNode*) alocarNaArena(arena, sizeof(PistaNode));
     strcpy(novo->pista, pista);
     novo->esquerda = NULL;
     novo->direita = NULL;
+    novo->altura = 1;
     return novo;
 }
 
 // ------------------------------
-// Função: inserirPista
-// Insere uma pista na árvore BST em ordem alfabética
+// Funções auxiliares da AVL
+// Altura, rotações e rebalanceamento de um nó
 // ------------------------------
-PistaNode* inserirPista(PistaNode* raiz, const char* pista) {
-    if (raiz == NULL) return criarPistaNode(pista);
+int alturaPista(PistaNode* no) {
+    return no ? no->altura : 0;
+}
+
+void atualizarAltura(PistaNode* no) {
+    int he = alturaPista(no->esquerda);
+    int hd = alturaPista(no->direita);
+    no->altura = 1 + (he > hd ? he : hd);
+}
+
+PistaNode* rotacaoDireita(PistaNode* y) {
+    PistaNode* x = y->esquerda;
+    y->esquerda = x->direita;
+    x->direita = y;
+    atualizarAltura(y);
+    atualizarAltura(x);
+    return x;
+}
 
-    if (strcmp(pista, raiz->pista) < 0) {
-        raiz->esquerda = inserirPista(raiz->esquerda, pista);
-    } else if (strcmp(pista, raiz->pista) > 0) {
-        raiz->direita = inserirPista(raiz->direita, pista);
+PistaNode* rotacaoEsquerda(PistaNode* x) {
+    PistaNode* y = x->direita;
+    x->direita = y->esquerda;
+    y->esquerda = x;
+    atualizarAltura(x);
+    atualizarAltura(y);
+    return y;
+}
+
+PistaNode* rebalancear(PistaNode* no) {
+    atualizarAltura(no);
+    int fator = alturaPista(no->esquerda) - alturaPista(no->direita);
+    if (fator > 1) {
+        if (alturaPista(no->esquerda->esquerda) < alturaPista(no->esquerda->direita))
+            no->esquerda = rotacaoEsquerda(no->esquerda);
+        return rotacaoDireita(no);
+    }
+    if (fator < -1) {
+        if (alturaPista(no->direita->direita) < alturaPista(no->direita->esquerda))
+            no->direita = rotacaoDireita(no->direita);
+        return rotacaoEsquerda(no);
     }
-    // se for igual, não insere novamente (evita duplicata)
-    return raiz;
+    return no;
+}
+
+// ------------------------------
+// Função: inserirPista
+// Insere uma pista na árvore em ordem alfabética e rebalanceia
+// ------------------------------
+PistaNode* inserirPista(Arena* arena, PistaNode* raiz, const char* pista) {
+    if (raiz == NULL) return criarPistaNode(arena, pista);
+
+    int cmp = strcmp(pista, raiz->pista);
+    if (cmp < 0) {
+        raiz->esquerda = inserirPista(arena, raiz->esquerda, pista);
+    } else if (cmp > 0) {
+        raiz->direita = inserirPista(arena, raiz->direita, pista);
+    } else {
+        return raiz;  // se for igual, não insere novamente (evita duplicata)
+    }
+    return rebalancear(raiz);
 }
 
 // ------------------------------
@@ -89,7 +174,7 @@ void exibirPistas(PistaNode* raiz) {
 // Função: explorarSalasComPistas
 // Controla a exploração da mansão e coleta as pistas
 // ------------------------------
-void explorarSalasComPistas(Sala* atual, PistaNode** arvorePistas) {
+void explorarSalasComPistas(Sala* atual, Arena* arena, PistaNode** arvorePistas) {
     char escolha;
 
     while (atual != NULL) {
@@ -98,7 +183,7 @@ void explorarSalasComPistas(Sala* atual, PistaNode** arvorePistas) {
         // Coleta pista (se existir)
         if (strlen(atual->pista) > 0) {
             printf("Você encontrou uma pista: %s\n", atual->pista);
-            *arvorePistas = inserirPista(*arvorePistas, atual->pista);
+            *arvorePistas = inserirPista(arena, *arvorePistas, atual->pista);
         }
 
         printf("\nEscolha um caminho:\n");
@@ -125,14 +210,17 @@ void explorarSalasComPistas(Sala* atual, PistaNode** arvorePistas) {
 // Função principal (main)
 // ------------------------------
 int main() {
+    // Uma arena para a mansão e as pistas (7 salas + no máximo 7 pistas)
+    Arena arena = criarArena(7 * (sizeof(Sala) + 16) + 7 * (sizeof(PistaNode) + 16));
+
     // Criando salas com pistas
-    Sala* hall       = criarSala("Hall de Entrada", "Pegada suspeita no tapete");
-    Sala* salaEstar  = criarSala("Sala de Estar", "Copo quebrado");
-    Sala* cozinha    = criarSala("Cozinha", "Faca ensanguentada");
-    Sala* biblioteca = criarSala("Biblioteca", "Livro fora de lugar");
-    Sala* jardim     = criarSala("Jardim", "");
-    Sala* quarto     = criarSala("Quarto", "Carta misteriosa");
-    Sala* adega      = criarSala("Adega", "Chave antiga");
+    Sala* hall       = criarSala(&arena, "Hall de Entrada", "Pegada suspeita no tapete");
+    Sala* salaEstar  = criarSala(&arena, "Sala de Estar", "Copo quebrado");
+    Sala* cozinha    = criarSala(&arena, "Cozinha", "Faca ensanguentada");
+    Sala* biblioteca = criarSala(&arena, "Biblioteca", "Livro fora de lugar");
+    Sala* jardim     = criarSala(&arena, "Jardim", "");
+    Sala* quarto     = criarSala(&arena, "Quarto", "Carta misteriosa");
+    Sala* adega      = criarSala(&arena, "Adega", "Chave antiga");
 
     // Montando o mapa da mansão (árvore fixa)
     hall->esquerda = salaEstar;
@@ -148,20 +236,14 @@ int main() {
     PistaNode* arvorePistas = NULL;
 
     // Início da exploração
-    explorarSalasComPistas(hall, &arvorePistas);
+    explorarSalasComPistas(hall, &arena, &arvorePistas);
 
     // Exibe pistas coletadas
     printf("\n--- Pistas coletadas (em ordem alfabética) ---\n");
     exibirPistas(arvorePistas);
 
-    // Liberação da memória (simplificação: não estou liberando recursivamente)
-    free(hall);
-    free(salaEstar);
-    free(cozinha);
-    free(biblioteca);
-    free(jardim);
-    free(quarto);
-    free(adega);
+    // Liberação da memória: salas e pistas saem com um único free
+    free(arena.dados);
 
     return 0;
 }
@@ -0,0 +1,306 @@
+// bench_estruturas.c
+// Benchmark das estruturas do nível Mestre (hash, BST de pistas,
+// mapa compacto).
+// Mede cada operação em tamanhos de 10 até --max (potências de 10)
+// e em três ordens de chave; a saída é CSV (ou JSON por linha com
+// --json) para comparar execuções e detectar regressões.
+#define DETECTIVE_SEM_MAIN
+#include "mestre.c"
+
+/* ============================================================
+   Geração de chaves
+   - ordenada:    "pista 0000000000", "pista 0000000001", ...
+   - aleatoria:   as mesmas chaves embaralhadas
+   - adversaria:  chaves longas com prefixo comum de 100 bytes,
+                  em ordem decrescente (pior caso para BST sem
+                  balanceamento e para comparações de chave)
+   ============================================================ */
+typedef enum { ORDEM_ORDENADA, ORDEM_ALEATORIA, ORDEM_ADVERSARIA, NUM_ORDENS } OrdemChaves;
+
+static const char* const NOME_ORDEM[NUM_ORDENS] = { "ordenada", "aleatoria", "adversaria" };
+
+#define PREFIXO_ADVERSARIO 100
+
+typedef struct Chaves {
+    char*  textos;      // todas as chaves, lado a lado
+    char** v;           // v[i] aponta para a i-ésima chave
+    size_t n;
+} Chaves;
+
+static void embaralhar(char** v, size_t n, uint64_t semente) {
+    for (size_t i = n; i > 1; --i) {
+        size_t j = (size_t) (proximoAleatorio(&semente) % i);
+        char* t = v[i-1]; v[i-1] = v[j]; v[j] = t;
+    }
+}
+
+static Chaves gerarChaves(size_t n, OrdemChaves ordem, const char* sufixo) {
+    size_t larg = (ordem == ORDEM_ADVERSARIA ? PREFIXO_ADVERSARIO : 6) + 10 + strlen(sufixo) + 1;
+    Chaves c;
+    c.n = n;
+    c.textos = (char*) malloc(n * larg);
+    c.v = (char**) malloc((n ? n : 1) * sizeof(char*));
+    if (!c.textos || !c.v) { fprintf(stderr, "Falha ao alocar chaves.\n"); exit(1); }
+    for (size_t i = 0; i < n; ++i) {
+        char* k = c.textos + i * larg;
+        if (ordem == ORDEM_ADVERSARIA) {
+            memset(k, 'x', PREFIXO_ADVERSARIO);
+            snprintf(k + PREFIXO_ADVERSARIO, larg - PREFIXO_ADVERSARIO, "%010zu%s", n - 1 - i, sufixo);
+        } else {
+            snprintf(k, larg, "pista %010zu%s", i, sufixo);
+        }
+        c.v[i] = k;
+    }
+    if (ordem == ORDEM_ALEATORIA) embaralhar(c.v, n, 42);
+    return c;
+}
+
+static void liberarChaves(Chaves* c) {
+    free(c->textos);
+    free(c->v);
+}
+
+/* ============================================================
+   Saída
+   ============================================================ */
+static FILE* saida;
+static int formatoJson;
+
+static void registrar(const char* operacao, OrdemChaves ordem, size_t n, size_t ops, double seg) {
+    double nsOp = ops ? seg * 1e9 / ops : 0.0;
+    if (formatoJson) {
+        fprintf(saida, "{\"operacao\":\"%s\",\"ordem\":\"%s\",\"n\":%zu,\"ops\":%zu,"
+                       "\"segundos\":%.6f,\"ns_por_op\":%.2f}\n",
+                operacao, NOME_ORDEM[ordem], n, ops, seg, nsOp);
+    } else {
+        fprintf(saida, "%s,%s,%zu,%zu,%.6f,%.2f\n", operacao, NOME_ORDEM[ordem], n, ops, seg, nsOp);
+    }
+    fflush(saida);
+}
+
+/* repeticoesPara() – tamanhos pequenos repetem até ~10^6 operações */
+static size_t repeticoesPara(size_t n) {
+    return n >= 1000000 ? 1 : 1000000 / n;
+}
+
+static const char* const SUSPEITOS[] = { "Mordomo", "Cozinheira", "Jardineiro", "Bibliotecária" };
+
+/* ============================================================
+   Casos de medição
+   ============================================================ */
+static volatile uint64_t sumidouro;   // impede o compilador de descartar os laços
+
+static void medirHashes(const Chaves* c, OrdemChaves ordem) {
+    size_t reps = repeticoesPara(c->n);
+    uint64_t acc = 0;
+    double t0 = segundosAgora();
+    for (size_t r = 0; r < reps; ++r)
+        for (size_t i = 0; i < c->n; ++i) acc += hash_djb2(c->v[i]);
+    registrar("hash_djb2", ordem, c->n, reps * c->n, segundosAgora() - t0);
+
+    t0 = segundosAgora();
+    for (size_t r = 0; r < reps; ++r)
+        for (size_t i = 0; i < c->n; ++i) acc += hash_rapido(c->v[i], strlen(c->v[i]));
+    registrar("hash_rapido", ordem, c->n, reps * c->n, segundosAgora() - t0);
+    sumidouro += acc;
+}
+
+static void medirTabela(const Chaves* c, const Chaves* ausentes, OrdemChaves ordem) {
+    size_t reps = repeticoesPara(c->n);
+    HashTable* ht = NULL;
+    double t0 = segundosAgora();
+    for (size_t r = 0; r < reps; ++r) {
+        if (ht) liberarHash(ht);
+        ht = criarHash(16);
+        for (size_t i = 0; i < c->n; ++i) inserirNaHash(ht, c->v[i], SUSPEITOS[i & 3]);
+    }
+    registrar("inserirNaHash", ordem, c->n, reps * c->n, segundosAgora() - t0);
+
+    uint64_t acc = 0;
+    t0 = segundosAgora();
+    for (size_t r = 0; r < reps; ++r)
+        for (size_t i = 0; i < c->n; ++i) acc += (uintptr_t) encontrarSuspeito(ht, c->v[i]);
+    registrar("encontrarSuspeito_acerto", ordem, c->n, reps * c->n, segundosAgora() - t0);
+
+    t0 = segundosAgora();
+    for (size_t r = 0; r < reps; ++r)
+        for (size_t i = 0; i < ausentes->n; ++i) acc += (uintptr_t) encontrarSuspeito(ht, ausentes->v[i]);
+    registrar("encontrarSuspeito_falha", ordem, c->n, reps * ausentes->n, segundosAgora() - t0);
+    sumidouro += acc;
+    liberarHash(ht);
+}
+
+static void medirArvore(const Chaves* c, OrdemChaves ordem) {
+    size_t reps = repeticoesPara(c->n);
+    Arena a;
+    arenaIniciar(&a);
+    PistaNode* raiz = NULL;
+    double t0 = segundosAgora();
+    for (size_t r = 0; r < reps; ++r) {
+        arenaResetar(&a);
+        raiz = NULL;
+        for (size_t i = 0; i < c->n; ++i) raiz = inserirPista(&a, raiz, c->v[i]);
+    }
+    registrar("inserirPista", ordem, c->n, reps * c->n, segundosAgora() - t0);
+
+    // exibirPistas() escreve em stdout, que aponta para /dev/null aqui
+    t0 = segundosAgora();
+    for (size_t r = 0; r < reps; ++r) exibirPistas(raiz);
+    fflush(stdout);
+    registrar("exibirPistas", ordem, c->n, reps * c->n, segundosAgora() - t0);
+
+    HashTable* ht = criarHash(c->n);
+    for (size_t i = 0; i < c->n; ++i) inserirNaHash(ht, c->v[i], SUSPEITOS[i & 3]);
+    uint64_t acc = 0;
+    t0 = segundosAgora();
+    Sessao sessao;
+    iniciarSessao(&sessao);
+    sessao.pistas = raiz;               // a árvore continua na arena 'a'
+    for (size_t r = 0; r < reps; ++r) acc += contarPistasParaSuspeito(&sessao, ht, "mordomo");
+    registrar("contarPistasParaSuspeito", ordem, c->n, reps * c->n, segundosAgora() - t0);
+
+    sumidouro += acc;
+
+    liberarSessao(&sessao);
+    liberarHash(ht);
+    arenaLiberar(&a);
+}
+
+/* ------------------------------------------------------------
+ * medirMapa() – caminhadas aleatórias raiz -> folha numa árvore de
+ * n salas: árvore de ponteiros (salas alocadas na arena em ordem de
+ * criação, embaralhadas ou invertidas, conforme a ordem) contra o
+ * mapa compacto em largura e em van Emde Boas. A forma da árvore é
+ * a mesma nas três ordens; só muda onde cada sala fica na memória.
+ * ------------------------------------------------------------ */
+static void medirMapa(size_t n, OrdemChaves ordem) {
+    // forma: cada sala nova desce da raiz por lados sorteados até
+    // achar uma saída livre
+    uint32_t* esq = (uint32_t*) malloc(n * sizeof(uint32_t));
+    uint32_t* dir = (uint32_t*) malloc(n * sizeof(uint32_t));
+    uint32_t* posicao = (uint32_t*) malloc(n * sizeof(uint32_t));
+    Sala** sala = (Sala**) malloc(n * sizeof(Sala*));
+    if (!esq || !dir || !posicao || !sala) { fprintf(stderr, "Falha ao alocar mapa.\n"); exit(1); }
+    memset(esq, 0xFF, n * sizeof(uint32_t));
+    memset(dir, 0xFF, n * sizeof(uint32_t));
+    uint64_t rng = 42;
+    for (uint32_t i = 1; i < n; ++i) {
+        uint32_t s = 0;
+        for (;;) {
+            uint32_t* lado = proximoAleatorio(&rng) & 1 ? &dir[s] : &esq[s];
+            if (*lado == SEM_INDICE) { *lado = i; break; }
+            s = *lado;
+        }
+    }
+    for (uint32_t i = 0; i < n; ++i) posicao[i] = ordem == ORDEM_ADVERSARIA ? (uint32_t) (n - 1 - i) : i;
+    if (ordem == ORDEM_ALEATORIA)
+        for (size_t i = n; i > 1; --i) {
+            size_t j = (size_t) (proximoAleatorio(&rng) % i);
+            uint32_t t = posicao[i-1]; posicao[i-1] = posicao[j]; posicao[j] = t;
+        }
+    Arena a;
+    arenaIniciar(&a);
+    Sala* bloco = (Sala*) arenaAlocar(&a, n * sizeof(Sala));
+    for (uint32_t i = 0; i < n; ++i) sala[i] = &bloco[posicao[i]];
+    for (uint32_t i = 0; i < n; ++i) {
+        sala[i]->nome = 0;
+        sala[i]->pista = SEM_PISTA;
+        sala[i]->esquerda = esq[i] != SEM_INDICE ? sala[esq[i]] : NULL;
+        sala[i]->direita  = dir[i] != SEM_INDICE ? sala[dir[i]] : NULL;
+    }
+    Sala* raiz = sala[0];
+    free(esq); free(dir); free(posicao); free(sala);
+
+    size_t caminhadas = n < 100000 ? 100000 : n;
+    uint64_t passos = 0, acc = 0;
+    rng = 7;
+    double t0 = segundosAgora();
+    for (size_t k = 0; k < caminhadas; ++k) {
+        const Sala* s = raiz;
+        for (;;) {
+            acc += s->nome;
+            passos++;
+            if (!s->esquerda && !s->direita) break;
+            uint64_t r = proximoAleatorio(&rng);
+            if (!s->esquerda) s = s->direita;
+            else if (!s->direita) s = s->esquerda;
+            else s = r & 1 ? s->direita : s->esquerda;
+        }
+    }
+    registrar("caminhada_ponteiros", ordem, n, passos, segundosAgora() - t0);
+
+    static const char* const NOME_CASO[] = { "caminhada_largura", "caminhada_veb" };
+    for (int o = MAPA_LARGURA; o <= MAPA_VEB; ++o) {
+        MapaSalas mapa;
+        montarMapa(&mapa, raiz, NULL, (OrdemMapa) o);
+        const SalaCompacta* salas = mapa.salas;
+        passos = 0;
+        rng = 7;
+        t0 = segundosAgora();
+        for (size_t k = 0; k < caminhadas; ++k) {
+            uint32_t s = 0;
+            for (;;) {
+                acc += salas[s].pista;
+                passos++;
+                if (salas[s].esq == SEM_INDICE && salas[s].dir == SEM_INDICE) break;
+                uint64_t r = proximoAleatorio(&rng);
+                if (salas[s].esq == SEM_INDICE) s = salas[s].dir;
+                else if (salas[s].dir == SEM_INDICE) s = salas[s].esq;
+                else s = r & 1 ? salas[s].dir : salas[s].esq;
+            }
+        }
+        registrar(NOME_CASO[o], ordem, n, passos, segundosAgora() - t0);
+        liberarMapa(&mapa);
+    }
+    sumidouro += acc;
+    arenaLiberar(&a);
+}
+
+/* ============================================================
+   main()
+   Uso: bench_estruturas [--max N] [--json] [--so OPERACAO]
+   ============================================================ */
+int main(int argc, char** argv) {
+    size_t maximo = 1000000;
+    const char* filtro = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            maximo = (size_t) strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--json") == 0) {
+            formatoJson = 1;
+        } else if (strcmp(argv[i], "--so") == 0 && i + 1 < argc) {
+            filtro = argv[++i];
+        } else {
+            fprintf(stderr, "Uso: %s [--max N (padrão 10^6, até 10^7)] [--json] "
+                            "[--so hash|tabela|arvore|mapa]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // resultados vão para o stdout original; o stdout do processo
+    // passa a descartar o que exibirPistas() imprime
+    saida = fdopen(dup(STDOUT_FILENO), "w");
+    if (!saida || !freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "Falha ao preparar a saída.\n");
+        return 1;
+    }
+    if (!formatoJson) fprintf(saida, "operacao,ordem,n,ops,segundos,ns_por_op\n");
+
+    for (size_t n = 10; n <= maximo; n *= 10) {
+        for (int o = 0; o < NUM_ORDENS; ++o) {
+            Chaves c = gerarChaves(n, (OrdemChaves) o, "");
+            if (!filtro || strcmp(filtro, "hash") == 0) medirHashes(&c, (OrdemChaves) o);
+            if (!filtro || strcmp(filtro, "tabela") == 0) {
+                Chaves ausentes = gerarChaves(n, (OrdemChaves) o, "?");
+                medirTabela(&c, &ausentes, (OrdemChaves) o);
+                liberarChaves(&ausentes);
+            }
+            if (!filtro || strcmp(filtro, "arvore") == 0) medirArvore(&c, (OrdemChaves) o);
+            if (!filtro || strcmp(filtro, "mapa") == 0) medirMapa(n, (OrdemChaves) o);
+            liberarChaves(&c);
+        }
+        if (n > SIZE_MAX / 10) break;
+    }
+    fclose(saida);
+    return 0;
+}
@@ -0,0 +1,272 @@
+// carga_servidor.c
+// Cliente de carga para o modo --servidor do mestre.
+// Mantém muitas sessões abertas ao mesmo tempo (--conexoes), cada
+// uma andando ao acaso pela mansão e terminando com uma acusação,
+// até completar --sessoes. Mede a latência de cada comando (do
+// envio até a linha de resposta) e resume no final.
+#define DETECTIVE_SEM_MAIN
+#include "mestre.c"
+
+#define CARGA_FAIXAS 64         // histograma de latência: faixa k = [2^k, 2^(k+1)) ns
+
+static const char* const SUSPEITOS[] = { "Mordomo", "Cozinheira", "Jardineiro", "Bibliotecária" };
+
+typedef struct Carga {
+    const char* caminho;
+    uint32_t    conexoes;       // simultâneas, por thread
+    uint64_t    sessoes;        // total, por thread
+    uint32_t    maxPassos;
+    uint64_t    semente;
+} Carga;
+
+typedef struct Cliente {
+    int      fd;
+    uint32_t passos;
+    uint64_t rng;
+    double   enviadoEm;
+    char     entrada[SERV_ENTRADA_MAX * 4];
+    size_t   numEntrada;
+} Cliente;
+
+typedef struct TrabalhadorCarga {
+    const Carga* carga;
+    uint32_t id;
+    uint64_t iniciadas, concluidas, sustentadas, comandos, erros;
+    uint64_t faixas[CARGA_FAIXAS];
+    double   somaLatencia, maxLatencia;
+    pthread_t thread;
+} TrabalhadorCarga;
+
+static void medirLatencia(TrabalhadorCarga* t, double seg) {
+    uint64_t ns = (uint64_t) (seg * 1e9);
+    int k = 0;
+    while (k < CARGA_FAIXAS - 1 && (ns >> (k + 1))) k++;
+    t->faixas[k]++;
+    t->somaLatencia += seg;
+    if (seg > t->maxLatencia) t->maxLatencia = seg;
+    t->comandos++;
+}
+
+static int enviarComando(Cliente* c, const char* cmd) {
+    size_t n = strlen(cmd), env = 0;
+    c->enviadoEm = segundosAgora();
+    while (env < n) {
+        ssize_t w = send(c->fd, cmd + env, n - env, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            return -1;
+        }
+        env += (size_t) w;
+    }
+    return 0;
+}
+
+/* abrirCliente() – conecta (bloqueante) e passa o socket para não bloqueante */
+static int abrirCliente(TrabalhadorCarga* t, int epfd, Cliente* c) {
+    struct sockaddr_un end;
+    memset(&end, 0, sizeof(end));
+    end.sun_family = AF_UNIX;
+    strncpy(end.sun_path, t->carga->caminho, sizeof(end.sun_path) - 1);
+    c->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (c->fd < 0) { perror("socket"); return -1; }
+    c->enviadoEm = segundosAgora();    // a SALA inicial também conta como resposta
+    if (connect(c->fd, (struct sockaddr*) &end, sizeof(end)) != 0) {
+        perror("connect");
+        close(c->fd);
+        c->fd = -1;
+        return -1;
+    }
+    fcntl(c->fd, F_SETFL, O_NONBLOCK);
+    c->passos = 0;
+    c->numEntrada = 0;
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = c;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev) != 0) { perror("epoll_ctl"); return -1; }
+    t->iniciadas++;
+    return 0;
+}
+
+static void fecharCliente(Cliente* c) {
+    close(c->fd);
+    c->fd = -1;
+}
+
+/* ------------------------------------------------------------
+ * responderLinha() – decide o próximo comando a partir da
+ * resposta do servidor. Retorna 1 quando a sessão acabou.
+ * ------------------------------------------------------------ */
+static int responderLinha(TrabalhadorCarga* t, Cliente* c, char* linha) {
+    medirLatencia(t, segundosAgora() - c->enviadoEm);
+    if (strncmp(linha, "SALA\t", 5) == 0) {
+        // SALA \t nome \t pista \t esquerda \t direita
+        char* campos[5] = { linha };
+        int n = 1;
+        for (char* p = linha; *p && n < 5; ++p)
+            if (*p == '\t') { *p = '\0'; campos[n++] = p + 1; }
+        int temEsq = n > 3 && *campos[3], temDir = n > 4 && *campos[4];
+        uint64_t r = proximoAleatorio(&c->rng);
+        char cmd[64];
+        if ((!temEsq && !temDir) || ++c->passos > t->carga->maxPassos || r % 100 < SIM_PARADA) {
+            snprintf(cmd, sizeof(cmd), "a %s\n", SUSPEITOS[(r >> 16) % 4]);
+        } else {
+            char lado = !temEsq ? 'd' : !temDir ? 'e' : (r >> 32) & 1 ? 'd' : 'e';
+            snprintf(cmd, sizeof(cmd), "%c\n", lado);
+        }
+        if (enviarComando(c, cmd) != 0) { t->erros++; return 1; }
+        return 0;
+    }
+    if (strncmp(linha, "VEREDITO\t", 9) == 0) {
+        t->concluidas++;
+        if (strstr(linha, "\tSUSTENTADA")) t->sustentadas++;
+        return 1;
+    }
+    t->erros++;
+    return 1;
+}
+
+static void* trabalharCarga(void* arg) {
+    TrabalhadorCarga* t = (TrabalhadorCarga*) arg;
+    const Carga* cg = t->carga;
+    int epfd = epoll_create1(0);
+    Cliente* clientes = (Cliente*) calloc(cg->conexoes, sizeof(Cliente));
+    if (epfd < 0 || !clientes) { fprintf(stderr, "Falha ao preparar o cliente de carga.\n"); exit(1); }
+
+    uint32_t abertos = 0;
+    for (uint32_t i = 0; i < cg->conexoes && t->iniciadas < cg->sessoes; ++i) {
+        clientes[i].rng = cg->semente ^ ((uint64_t) t->id << 32) ^ i;
+        if (abrirCliente(t, epfd, &clientes[i]) != 0) break;
+        abertos++;
+    }
+
+    struct epoll_event ev[64];
+    while (abertos) {
+        int n = epoll_wait(epfd, ev, 64, 1000);
+        if (n < 0) { if (errno == EINTR) continue; perror("epoll_wait"); break; }
+        if (n == 0) { fprintf(stderr, "Servidor parou de responder.\n"); break; }
+        for (int i = 0; i < n; ++i) {
+            Cliente* c = (Cliente*) ev[i].data.ptr;
+            int fim = 0;
+            ssize_t r = read(c->fd, c->entrada + c->numEntrada, sizeof(c->entrada) - c->numEntrada);
+            if (r <= 0) {
+                if (r < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                t->erros++;
+                fim = 1;
+            } else {
+                c->numEntrada += (size_t) r;
+                char* ini = c->entrada;
+                char* nl;
+                while (!fim && (nl = memchr(ini, '\n', c->numEntrada - (size_t) (ini - c->entrada))) != NULL) {
+                    *nl = '\0';
+                    fim = responderLinha(t, c, ini);
+                    ini = nl + 1;
+                }
+                c->numEntrada -= (size_t) (ini - c->entrada);
+                memmove(c->entrada, ini, c->numEntrada);
+                if (c->numEntrada == sizeof(c->entrada)) { t->erros++; fim = 1; }
+            }
+            if (fim) {
+                fecharCliente(c);
+                abertos--;
+                if (t->iniciadas < cg->sessoes && abrirCliente(t, epfd, c) == 0) abertos++;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < cg->conexoes; ++i)
+        if (clientes[i].fd > 0) close(clientes[i].fd);
+    free(clientes);
+    close(epfd);
+    return NULL;
+}
+
+/* percentil() – limite superior da faixa onde cai a fração q,
+ * sem passar da maior latência medida (também um limite superior) */
+static double percentil(const uint64_t* faixas, uint64_t total, double q, double maximo) {
+    uint64_t alvo = (uint64_t) (q * total), acc = 0;
+    for (int k = 0; k < CARGA_FAIXAS; ++k) {
+        acc += faixas[k];
+        if (acc > alvo) {
+            double limite = (double) (2ull << k) / 1e9;
+            return limite < maximo ? limite : maximo;
+        }
+    }
+    return 0.0;
+}
+
+/* ============================================================
+   main()
+   Uso: carga_servidor SOCKET [--conexoes C] [--sessoes N]
+                              [--threads T] [--passos P] [--semente S]
+   ============================================================ */
+int main(int argc, char** argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        fprintf(stderr, "Uso: %s SOCKET [--conexoes C (padrão 1000)] [--sessoes N (padrão 100000)] "
+                        "[--threads T] [--passos P] [--semente S]\n", argv[0]);
+        return 1;
+    }
+    Carga cg = { argv[1], 1000, 100000, 64, 1 };
+    unsigned long numThreads = 1;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--conexoes") == 0 && i + 1 < argc) {
+            cg.conexoes = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--sessoes") == 0 && i + 1 < argc) {
+            cg.sessoes = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--passos") == 0 && i + 1 < argc) {
+            cg.maxPassos = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            cg.semente = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (numThreads == 0) numThreads = 1;
+    if (cg.conexoes < numThreads) cg.conexoes = (uint32_t) numThreads;
+
+    // conexões e sessões divididas entre as threads
+    Carga* partes = (Carga*) malloc(numThreads * sizeof(Carga));
+    TrabalhadorCarga* ts = (TrabalhadorCarga*) calloc(numThreads, sizeof(TrabalhadorCarga));
+    if (!partes || !ts) { fprintf(stderr, "Falha ao alocar threads.\n"); return 1; }
+    double t0 = segundosAgora();
+    for (unsigned long i = 0; i < numThreads; ++i) {
+        partes[i] = cg;
+        partes[i].conexoes = (uint32_t) (cg.conexoes * (i + 1) / numThreads - cg.conexoes * i / numThreads);
+        partes[i].sessoes = cg.sessoes * (i + 1) / numThreads - cg.sessoes * i / numThreads;
+        ts[i].carga = &partes[i];
+        ts[i].id = (uint32_t) i;
+        if (i && pthread_create(&ts[i].thread, NULL, trabalharCarga, &ts[i]) != 0) {
+            fprintf(stderr, "Falha ao criar thread.\n");
+            return 1;
+        }
+    }
+    trabalharCarga(&ts[0]);
+    for (unsigned long i = 1; i < numThreads; ++i) pthread_join(ts[i].thread, NULL);
+    double dt = segundosAgora() - t0;
+
+    TrabalhadorCarga tot;
+    memset(&tot, 0, sizeof(tot));
+    for (unsigned long i = 0; i < numThreads; ++i) {
+        tot.concluidas  += ts[i].concluidas;
+        tot.sustentadas += ts[i].sustentadas;
+        tot.comandos    += ts[i].comandos;
+        tot.erros       += ts[i].erros;
+        tot.somaLatencia += ts[i].somaLatencia;
+        if (ts[i].maxLatencia > tot.maxLatencia) tot.maxLatencia = ts[i].maxLatencia;
+        for (int k = 0; k < CARGA_FAIXAS; ++k) tot.faixas[k] += ts[i].faixas[k];
+    }
+    printf("Sessões concluídas: %llu em %.3f s (%.0f sessões/s, %u conexões simultâneas, %lu threads)\n",
+           (unsigned long long) tot.concluidas, dt, dt > 0 ? tot.concluidas / dt : 0.0,
+           cg.conexoes, numThreads);
+    printf("Comandos: %llu (%.0f/s), %llu erro(s), %llu acusação(ões) sustentada(s)\n",
+           (unsigned long long) tot.comandos, dt > 0 ? tot.comandos / dt : 0.0,
+           (unsigned long long) tot.erros, (unsigned long long) tot.sustentadas);
+    printf("Latência por comando: média %.1f us, p50 ≤ %.1f us, p99 ≤ %.1f us, máx %.1f us\n",
+           tot.comandos ? tot.somaLatencia / tot.comandos * 1e6 : 0.0,
+           percentil(tot.faixas, tot.comandos, 0.50, tot.maxLatencia) * 1e6,
+           percentil(tot.faixas, tot.comandos, 0.99, tot.maxLatencia) * 1e6, tot.maxLatencia * 1e6);
+    free(partes);
+    free(ts);
+    return tot.erros ? 1 : 0;
+}
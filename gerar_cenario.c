@@ -0,0 +1,267 @@
+// gerar_cenario.c
+// Gera cenários sintéticos no formato binário DQC1 (ESTRUTURA 4 de
+// mestre.c) para testar o mapa, a BST de pistas e a hash de
+// suspeitos em escala, de 10^3 a 10^8 salas.
+// Todas as formas são numeradas em largura a partir da raiz (como
+// em exportarCenario()), então cada sala, pista e suspeito sai de
+// uma função do próprio índice e o arquivo é escrito em fluxo, sem
+// guardar o mapa na memória.
+// Uso: gerar_cenario [opções] ARQ
+//      mestre --cenario ARQ --simular 100000
+#define DETECTIVE_SEM_MAIN
+#define DETECTIVE_SEM_PADRAO
+#include "mestre.c"
+
+/* ============================================================
+   Formas do mapa (filhos de cada sala, na ordem da largura)
+   - balanceada:  dois filhos por sala enquanto houver salas
+                  (heap: filhos de i em 2i+1 e 2i+2)
+   - degenerada:  um filho por sala, de lado sorteado (lista)
+   - aleatoria:   0, 1 ou 2 filhos com chances 1/4, 1/2, 1/4
+                  (processo de Galton-Watson crítico; altura da
+                  ordem de raiz de n), nunca morrendo antes de n
+   Textos das pistas (ordem em que as salas os revelam)
+   - ordenada:    "pista 0000000000", "pista 0000000001", ...
+   - aleatoria:   os mesmos textos sorteados por sala
+   - adversaria:  prefixo comum de 100 bytes e ordem decrescente
+                  (pior caso para BST sem balanceamento e para
+                  comparações de chave)
+   ============================================================ */
+typedef enum { FORMA_BALANCEADA, FORMA_DEGENERADA, FORMA_ALEATORIA } FormaMapa;
+typedef enum { TEXTOS_ORDENADA, TEXTOS_ALEATORIA, TEXTOS_ADVERSARIA } OrdemTextos;
+
+#define PREFIXO_ADVERSARIO 100
+#define GERADOR_BUFFER     (1u << 20)
+
+typedef struct Gerador {
+    uint32_t    numSalas, numPistas, numSuspeitos;
+    uint32_t    densidade;          // % de salas com pista
+    FormaMapa   forma;
+    OrdemTextos textos;
+    uint64_t    semente;
+} Gerador;
+
+static uint32_t digitos(uint32_t v) {
+    uint32_t d = 1;
+    while (v >= 10) { v /= 10; d++; }
+    return d;
+}
+
+/* Tamanhos (com o '\0') de cada string, sem formatá-las */
+static uint64_t tamNomeSala(uint32_t i)     { return 5 + digitos(i) + 1; }        // "Sala %u"
+static uint64_t tamNomeSuspeito(uint32_t s) { return 9 + digitos(s) + 1; }        // "Suspeito %u"
+static uint64_t tamTextoPista(const Gerador* g) {
+    return (g->textos == TEXTOS_ADVERSARIA ? PREFIXO_ADVERSARIO : 6) + 10 + 1;    // largura fixa
+}
+
+static void textoPistaGerada(const Gerador* g, uint32_t k, char* buf) {
+    if (g->textos == TEXTOS_ADVERSARIA) {
+        memset(buf, 'x', PREFIXO_ADVERSARIO);
+        snprintf(buf + PREFIXO_ADVERSARIO, 12, "%010u", g->numPistas - 1 - k);
+    } else {
+        snprintf(buf, 17, "pista %010u", k);
+    }
+}
+
+/* suspeitoGerado() – função do índice, para a pista sair igual em
+ * qualquer passada */
+static uint32_t suspeitoGerado(const Gerador* g, uint32_t k) {
+    if (g->numSuspeitos == 0) return SEM_INDICE;
+    uint64_t x = g->semente ^ ((uint64_t) k * 0x9e3779b97f4a7c15ull);
+    return (uint32_t) (proximoAleatorio(&x) % g->numSuspeitos);
+}
+
+static void gravar(FILE* f, const void* p, size_t tam, int* ok) {
+    if (*ok && fwrite(p, 1, tam, f) != tam) *ok = 0;
+}
+
+/* ------------------------------------------------------------
+ * gerarCenario() – grava o cenário em 'caminho'. Os deslocamentos
+ * das strings (nomes das salas, textos das pistas, nomes dos
+ * suspeitos, nessa ordem) são calculados antes, pelos tamanhos.
+ * Retorna 0 em caso de sucesso, -1 em caso de erro.
+ * ------------------------------------------------------------ */
+static int gerarCenario(const Gerador* g, const char* caminho) {
+    uint64_t tamNomes = 0, tamSusp = 0;
+    for (uint32_t i = 0; i < g->numSalas; ++i) tamNomes += tamNomeSala(i);
+    for (uint32_t s = 0; s < g->numSuspeitos; ++s) tamSusp += tamNomeSuspeito(s);
+    uint64_t tamPistas = (uint64_t) g->numPistas * tamTextoPista(g);
+    uint64_t tamStrings = tamNomes + tamPistas + tamSusp;
+    uint64_t preenchimento = (4 - tamStrings % 4) % 4;
+    if (tamStrings > UINT32_MAX) {
+        fprintf(stderr, "Strings demais para o formato (%llu bytes; o limite é 4 GiB): "
+                        "reduza --pistas ou --salas.\n", (unsigned long long) tamStrings);
+        return -1;
+    }
+
+    CabecalhoCenario cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magica, CENARIO_MAGICA, 4);
+    cab.versao       = CENARIO_VERSAO;
+    cab.numSalas     = g->numSalas;
+    cab.numPistas    = g->numPistas;
+    cab.numSuspeitos = g->numSuspeitos;
+    cab.numRelacoes  = g->numSuspeitos ? g->numPistas : 0;    // uma por pista, peso 1
+    cab.raiz         = 0;
+    cab.offSalas     = sizeof(cab);
+    cab.offPistas    = cab.offSalas + (uint64_t) g->numSalas * sizeof(SalaRec);
+    cab.offRelacoes  = cab.offPistas + (uint64_t) g->numPistas * sizeof(PistaRec);
+    cab.offSuspeitos = cab.offRelacoes + (uint64_t) cab.numRelacoes * sizeof(RelacaoRec);
+    cab.offStrings   = cab.offSuspeitos + (uint64_t) g->numSuspeitos * sizeof(SuspeitoRec);
+    cab.tamStrings   = tamStrings + preenchimento;
+
+    FILE* f = fopen(caminho, "wb");
+    if (!f) { fprintf(stderr, "Não foi possível criar '%s'.\n", caminho); return -1; }
+    setvbuf(f, NULL, _IOFBF, GERADOR_BUFFER);
+    int ok = 1;
+    gravar(f, &cab, sizeof(cab), &ok);
+
+    // 1) salas: a forma decide quantos filhos cada uma ganha; os
+    // filhos recebem os próximos índices da largura
+    uint64_t rngForma = g->semente, rngPistas = g->semente ^ 0x5851f42d4c957f2dull;
+    uint32_t proximo = 1, fimNivel = 1, altura = 0, comPista = 0;
+    uint32_t offNome = 0;
+    for (uint32_t i = 0; i < g->numSalas && ok; ++i) {
+        if (i == fimNivel) { altura++; fimNivel = proximo; }
+        uint64_t r = proximoAleatorio(&rngForma);
+        uint32_t filhos;
+        switch (g->forma) {
+            case FORMA_BALANCEADA: filhos = 2; break;
+            case FORMA_DEGENERADA: filhos = 1; break;
+            default:               filhos = (uint32_t) (r % 4 + 1) / 2; break;   // 0, 1, 1, 2
+        }
+        if (filhos == 0 && proximo == i + 1) filhos = 1;    // a largura não pode esvaziar antes de n
+        if (filhos > g->numSalas - proximo) filhos = g->numSalas - proximo;
+
+        SalaRec rec;
+        rec.nome = offNome;
+        rec.esq = rec.dir = rec.pista = SEM_INDICE;
+        if (filhos == 2) {
+            rec.esq = proximo++;
+            rec.dir = proximo++;
+        } else if (filhos == 1) {
+            if ((r >> 32) & 1) rec.dir = proximo++;
+            else               rec.esq = proximo++;
+        }
+        offNome += (uint32_t) tamNomeSala(i);
+
+        if (g->numPistas && proximoAleatorio(&rngPistas) % 100 < g->densidade) {
+            rec.pista = g->textos == TEXTOS_ALEATORIA
+                      ? (uint32_t) (proximoAleatorio(&rngPistas) % g->numPistas)
+                      : comPista % g->numPistas;
+            comPista++;
+        }
+        gravar(f, &rec, sizeof(rec), &ok);
+    }
+
+    // 2) pistas (a pista k fica com a relação k), relações e suspeitos
+    uint32_t offTexto = (uint32_t) tamNomes;
+    for (uint32_t k = 0; k < g->numPistas && ok; ++k) {
+        PistaRec p = { offTexto, suspeitoGerado(g, k), cab.numRelacoes ? k : 0, cab.numRelacoes ? 1 : 0 };
+        offTexto += (uint32_t) tamTextoPista(g);
+        gravar(f, &p, sizeof(p), &ok);
+    }
+    for (uint32_t k = 0; k < cab.numRelacoes && ok; ++k) {
+        RelacaoRec r = { suspeitoGerado(g, k), 1 };
+        gravar(f, &r, sizeof(r), &ok);
+    }
+    uint32_t offSusp = (uint32_t) (tamNomes + tamPistas);
+    for (uint32_t s = 0; s < g->numSuspeitos && ok; ++s) {
+        SuspeitoRec rec = { offSusp };
+        offSusp += (uint32_t) tamNomeSuspeito(s);
+        gravar(f, &rec, sizeof(rec), &ok);
+    }
+
+    // 3) strings, na mesma ordem dos deslocamentos
+    char buf[PREFIXO_ADVERSARIO + 32];
+    for (uint32_t i = 0; i < g->numSalas && ok; ++i) {
+        snprintf(buf, sizeof(buf), "Sala %u", i);
+        gravar(f, buf, tamNomeSala(i), &ok);
+    }
+    for (uint32_t k = 0; k < g->numPistas && ok; ++k) {
+        textoPistaGerada(g, k, buf);
+        gravar(f, buf, tamTextoPista(g), &ok);
+    }
+    for (uint32_t s = 0; s < g->numSuspeitos && ok; ++s) {
+        snprintf(buf, sizeof(buf), "Suspeito %u", s);
+        gravar(f, buf, tamNomeSuspeito(s), &ok);
+    }
+    static const char zeros[4];
+    gravar(f, zeros, preenchimento, &ok);
+
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) { fprintf(stderr, "Falha ao gravar o cenário '%s'.\n", caminho); return -1; }
+    fprintf(stderr, "Cenário '%s': %u salas (altura %u), %u com pista, %u pistas distintas, "
+                    "%u suspeitos, %llu bytes\n",
+            caminho, g->numSalas, altura, comPista, g->numPistas, g->numSuspeitos,
+            (unsigned long long) (cab.offStrings + cab.tamStrings));
+    return 0;
+}
+
+static void mostrarUso(const char* prog) {
+    fprintf(stderr,
+        "Uso: %s [opções] ARQ\n"
+        "  --salas N           salas no mapa (padrão: 1000; até 4294967294)\n"
+        "  --forma F           balanceada|degenerada|aleatoria (padrão: aleatoria)\n"
+        "  --densidade PCT     %% de salas com pista (padrão: 50)\n"
+        "  --pistas P          textos de pista distintos (padrão: salas * densidade)\n"
+        "  --suspeitos S       suspeitos (padrão: 4)\n"
+        "  --textos T          ordenada|aleatoria|adversaria (padrão: aleatoria)\n"
+        "  --semente X         semente do sorteio (padrão: 1)\n",
+        prog);
+}
+
+/* lerNumero() – inteiro sem sinal de até 'maximo'; -1 se inválido */
+static int lerNumero(const char* s, uint64_t maximo, uint64_t* v) {
+    char* fim;
+    errno = 0;
+    unsigned long long x = strtoull(s, &fim, 10);
+    if (errno || fim == s || *fim || *s == '-' || x > maximo) return -1;
+    *v = x;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Gerador g = { 1000, 0, 4, 50, FORMA_ALEATORIA, TEXTOS_ALEATORIA, 1 };
+    const char* caminho = NULL;
+    int pistasDadas = 0;
+    for (int i = 1; i < argc; ++i) {
+        uint64_t v;
+        const char* valor = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--salas") == 0 && valor && lerNumero(valor, UINT32_MAX - 1, &v) == 0 && v > 0) {
+            g.numSalas = (uint32_t) v; i++;
+        } else if (strcmp(argv[i], "--densidade") == 0 && valor && lerNumero(valor, 100, &v) == 0) {
+            g.densidade = (uint32_t) v; i++;
+        } else if (strcmp(argv[i], "--pistas") == 0 && valor && lerNumero(valor, UINT32_MAX - 1, &v) == 0) {
+            g.numPistas = (uint32_t) v; pistasDadas = 1; i++;
+        } else if (strcmp(argv[i], "--suspeitos") == 0 && valor && lerNumero(valor, UINT32_MAX - 1, &v) == 0) {
+            g.numSuspeitos = (uint32_t) v; i++;
+        } else if (strcmp(argv[i], "--semente") == 0 && valor && lerNumero(valor, UINT64_MAX, &v) == 0) {
+            g.semente = v; i++;
+        } else if (strcmp(argv[i], "--forma") == 0 && valor) {
+            if      (strcmp(valor, "balanceada") == 0) g.forma = FORMA_BALANCEADA;
+            else if (strcmp(valor, "degenerada") == 0) g.forma = FORMA_DEGENERADA;
+            else if (strcmp(valor, "aleatoria") == 0)  g.forma = FORMA_ALEATORIA;
+            else { mostrarUso(argv[0]); return 1; }
+            i++;
+        } else if (strcmp(argv[i], "--textos") == 0 && valor) {
+            if      (strcmp(valor, "ordenada") == 0)   g.textos = TEXTOS_ORDENADA;
+            else if (strcmp(valor, "aleatoria") == 0)  g.textos = TEXTOS_ALEATORIA;
+            else if (strcmp(valor, "adversaria") == 0) g.textos = TEXTOS_ADVERSARIA;
+            else { mostrarUso(argv[0]); return 1; }
+            i++;
+        } else if (argv[i][0] != '-' && !caminho) {
+            caminho = argv[i];
+        } else {
+            mostrarUso(argv[0]);
+            return 1;
+        }
+    }
+    if (!caminho) { mostrarUso(argv[0]); return 1; }
+    if (!pistasDadas) {
+        uint64_t p = (uint64_t) g.numSalas * g.densidade / 100;
+        g.numPistas = g.densidade && p == 0 ? 1 : (uint32_t) p;
+    }
+    if (g.numPistas == 0) g.densidade = 0;
+    return gerarCenario(&g, caminho) == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+// gerar_padrao.c
+// Gera mansao_padrao.h: a mansão padrão do nível Mestre (textos do
+// pool, salas e associações pista -> suspeito) como tabelas estáticas,
+// para o jogo começar sem malloc e sem calcular hash nenhum.
+// As tabelas saem do próprio código de mestre.c: a mansão e as
+// associações são montadas como em tempo de execução e o estado
+// resultante é despejado, então nunca divergem. Os índices de
+// endereçamento aberto (textos e suspeitos) ganham a menor
+// capacidade, potência de 2, em que nenhuma chave colide – hash
+// perfeito, uma sondagem por busca.
+// Uso: gerar_padrao > build/mansao_padrao.h (o make já faz isso)
+#define DETECTIVE_SEM_MAIN
+#define DETECTIVE_SEM_PADRAO
+#include "mestre.c"
+
+/* escreverLiteral() – texto como literal C (bytes fora do ASCII
+ * imprimível viram escapes octais) */
+static void escreverLiteral(FILE* f, const char* s) {
+    fputc('"', f);
+    for (const unsigned char* p = (const unsigned char*) s; *p; ++p) {
+        if (*p == '"' || *p == '\\') fprintf(f, "\\%c", *p);
+        else if (*p >= 0x20 && *p < 0x7F) fputc(*p, f);
+        else fprintf(f, "\\%03o", *p);
+    }
+    fputc('"', f);
+}
+
+/* capacidadePerfeita() – menor potência de 2 >= minimo em que os
+ * hashes caem todos em posições distintas */
+static size_t capacidadePerfeita(const uint32_t* hashes, uint32_t n, size_t minimo) {
+    for (size_t cap = minimo; cap <= ((size_t) 1 << 24); cap *= 2) {
+        uint8_t* usada = (uint8_t*) calloc(cap, 1);
+        if (!usada) break;
+        uint32_t i = 0;
+        while (i < n && !usada[hashes[i] & (cap - 1)]) usada[hashes[i++] & (cap - 1)] = 1;
+        free(usada);
+        if (i == n) return cap;
+    }
+    fprintf(stderr, "Sem capacidade livre de colisões para %u chaves.\n", n);
+    exit(1);
+}
+
+/* escreverIndice() – vetor completo do índice (id + 1 por posição) */
+static void escreverIndice(FILE* f, const char* nome, const uint32_t* hashes, uint32_t n, size_t cap) {
+    uint32_t* pos = (uint32_t*) calloc(cap, sizeof(uint32_t));
+    if (!pos) { fprintf(stderr, "Falha ao alocar índice.\n"); exit(1); }
+    for (uint32_t i = 0; i < n; ++i) pos[hashes[i] & (cap - 1)] = i + 1;
+    fprintf(f, "#define %s { \\\n   ", nome);
+    for (size_t i = 0; i < cap; ++i) fprintf(f, " %uu,%s", pos[i], i % 16 == 15 && i + 1 < cap ? " \\\n   " : "");
+    fprintf(f, " }\n");
+    free(pos);
+}
+
+static void escreverVetor(FILE* f, const char* nome, const uint32_t* v, size_t n) {
+    fprintf(f, "#define %s { \\\n   ", nome);
+    for (size_t i = 0; i < n; ++i)
+        fprintf(f, " 0x%xu,%s", v[i], i % 8 == 7 && i + 1 < n ? " \\\n   " : "");
+    fprintf(f, " }\n");
+}
+
+int main(void) {
+    FILE* f = stdout;
+    Arena mapa;
+    arenaIniciar(&mapa);
+    Sala* hall = montarMansaoPadrao(&mapa);
+    HashTable* ht = criarHash(101);
+    carregarAssociacoes(ht);
+    // pistas do catálogo sem suspeito também ganham id
+    uint32_t idsPistas[NUM_PISTAS_PADRAO];
+    for (int i = 0; i < NUM_PISTAS_PADRAO; ++i) idsPistas[i] = internarStr(TEXTO_PISTA[i]);
+
+    fprintf(f, "/* mansao_padrao.h – gerado por gerar_padrao a partir de mestre.c; não edite. */\n");
+    fprintf(f, "#define MANSAO_PADRAO_GERADA 1\n\n");
+
+    // Textos do pool, na ordem dos ids
+    uint32_t numIds = numTextos();
+    uint32_t* hashes = (uint32_t*) malloc(numIds * sizeof(uint32_t));
+    if (!hashes) { fprintf(stderr, "Falha ao alocar hashes.\n"); return 1; }
+    fprintf(f, "#define PADRAO_NUM_TEXTOS %uu\n#define PADRAO_TEXTOS { \\\n", numIds);
+    for (uint32_t id = 0; id < numIds; ++id) {
+        const EntradaTexto* e = entradaTexto(id);
+        hashes[id] = e->hash;
+        fprintf(f, "    { ");
+        escreverLiteral(f, e->texto);
+        fprintf(f, ", %uu, 0x%08xu }, \\\n", e->tam, e->hash);
+    }
+    fprintf(f, "}\n");
+    size_t capTextos = capacidadePerfeita(hashes, numIds,
+                                          atomic_load(&poolTextos.indice)->capacidade);
+    fprintf(f, "#define PADRAO_CAP_INDICE_TEXTOS %zuu\n", capTextos);
+    escreverIndice(f, "PADRAO_INDICE_TEXTOS", hashes, numIds, capTextos);
+    escreverVetor(f, "PADRAO_ID_PISTAS", idsPistas, NUM_PISTAS_PADRAO);
+    free(hashes);
+
+    // Salas, em ordem de largura (o índice é o de indiceDaSala())
+    uint32_t numSalas = (uint32_t) contarSalas(hall);
+    fprintf(f, "\n#define PADRAO_NUM_SALAS %uu\n#define PADRAO_SALAS { \\\n", numSalas);
+    for (uint32_t i = 0; i < numSalas; ++i) {
+        Sala* s = salaDoIndice(hall, i);
+        fprintf(f, "    { %uu, %d, ", s->nome, s->pista);
+        if (s->esquerda) fprintf(f, "&salasEmbutidas[%u], ", indiceDaSala(hall, s->esquerda));
+        else             fprintf(f, "NULL, ");
+        if (s->direita)  fprintf(f, "&salasEmbutidas[%u] }, \\\n", indiceDaSala(hall, s->direita));
+        else             fprintf(f, "NULL }, \\\n");
+    }
+    fprintf(f, "}\n\n");
+
+    // Associações: vetores da HashTable como estão depois de carregarAssociacoes()
+    fprintf(f, "#define PADRAO_CAP_TEXTOS_HASH %zuu\n", ht->capacidade);
+    escreverVetor(f, "PADRAO_PISTA_DO_TEXTO", ht->pistaDoTexto, ht->capacidade);
+    fprintf(f, "#define PADRAO_NUM_PISTAS %uu\n#define PADRAO_CAP_PISTAS %uu\n#define PADRAO_OCUPADOS %zuu\n",
+            ht->numPistas, ht->capPistas, ht->ocupados);
+    escreverVetor(f, "PADRAO_PRINCIPAL", ht->principal, ht->numPistas);
+
+    uint32_t numNos = 0;
+    fprintf(f, "#define PADRAO_NOS { \\\n");
+    for (uint32_t p = 0; p < ht->numPistas; ++p)
+        for (const Relacao* r = ht->relacoes[p]; r; r = r->prox, ++numNos) {
+            fprintf(f, "    { %uu, %uu, ", r->suspeito, r->peso);
+            if (r->prox) fprintf(f, "&nosEmbutidos[%u] }, \\\n", numNos + 1);
+            else         fprintf(f, "NULL }, \\\n");
+        }
+    fprintf(f, "}\n#define PADRAO_NUM_RELACOES %uu\n#define PADRAO_RELACOES {", numNos);
+    numNos = 0;
+    for (uint32_t p = 0; p < ht->numPistas; ++p) {
+        if (ht->relacoes[p]) fprintf(f, " &nosEmbutidos[%u],", numNos);
+        else                 fprintf(f, " NULL,");
+        for (const Relacao* r = ht->relacoes[p]; r; r = r->prox) numNos++;
+    }
+    fprintf(f, " }\n");
+
+    fprintf(f, "#define PADRAO_NUM_SUSPEITOS %uu\n#define PADRAO_CAP_SUSPEITOS %uu\n"
+               "#define PADRAO_NOMES_SUSPEITOS {", ht->numSuspeitos, ht->capSuspeitos);
+    uint32_t* hashesSusp = (uint32_t*) malloc((ht->numSuspeitos ? ht->numSuspeitos : 1) * sizeof(uint32_t));
+    if (!hashesSusp) { fprintf(stderr, "Falha ao alocar hashes.\n"); return 1; }
+    for (uint32_t s = 0; s < ht->numSuspeitos; ++s) {
+        fputc(' ', f);
+        escreverLiteral(f, ht->nomesSuspeitos[s]);
+        fputc(',', f);
+        hashesSusp[s] = hashSuspeito(ht->nomesSuspeitos[s]);
+    }
+    fprintf(f, " }\n");
+    size_t capSusp = capacidadePerfeita(hashesSusp, ht->numSuspeitos, ht->capIndice);
+    fprintf(f, "#define PADRAO_CAP_INDICE_SUSPEITOS %zuu\n", capSusp);
+    escreverIndice(f, "PADRAO_INDICE_SUSPEITOS", hashesSusp, ht->numSuspeitos, capSusp);
+    free(hashesSusp);
+
+    liberarHash(ht);
+    arenaLiberar(&mapa);
+    liberarTextos();
+    return ferror(f) ? 1 : 0;
+}
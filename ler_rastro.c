@@ -0,0 +1,346 @@
+// ler_rastro.c
+// Lê um rastro gravado com mestre --rastro (formato DQT1, ver
+// "Rastro binário de sessões" em mestre.c) e o reproduz evento a
+// evento, em ordem de tempo, ou resume a sessão inteira.
+// Os textos (salas, pistas, nomes acusados) vêm do rodapé; salas
+// de cenário só ganham nome com --cenario. Um rastro sem rodapé
+// (processo interrompido) ainda é lido, só que sem os textos.
+// Uso: ler_rastro [--resumo] [--sessao N] [--cenario ARQ] RASTRO
+#define DETECTIVE_SEM_MAIN
+#define DETECTIVE_SEM_PADRAO
+#include "mestre.c"
+
+#define RESUMO_TOP 10
+
+typedef struct Rastro {
+    const unsigned char*  base;
+    size_t                tamanho;
+    const RegistroRastro* regs;
+    size_t                numRegs;
+    uint64_t*             tempos;       // ns de cada registro (relógio da sua thread)
+    const RodapeRastro*   rodape;       // NULL se o rastro não foi encerrado
+    const char**          textos;       // id -> texto (rodapé)
+    uint32_t              numTextos;
+} Rastro;
+
+/* ------------------------------------------------------------
+ * abrirRastroLido() – mapeia o arquivo, acha o rodapé, dá a cada
+ * registro o instante do último RASTRO_RELOGIO da sua thread e
+ * indexa os textos. Retorna 0 em caso de sucesso, -1 em caso de
+ * erro.
+ * ------------------------------------------------------------ */
+static int abrirRastroLido(Rastro* r, const char* caminho) {
+    memset(r, 0, sizeof(*r));
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { fprintf(stderr, "Não foi possível abrir o rastro '%s'.\n", caminho); return -1; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CabecalhoRastro)) {
+        fprintf(stderr, "Rastro '%s' vazio ou ilegível.\n", caminho);
+        close(fd);
+        return -1;
+    }
+    r->tamanho = (size_t) st.st_size;
+    void* m = mmap(NULL, r->tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) { fprintf(stderr, "Falha ao mapear o rastro '%s'.\n", caminho); return -1; }
+    r->base = (const unsigned char*) m;
+
+    const CabecalhoRastro* cab = (const CabecalhoRastro*) m;
+    if (memcmp(cab->magica, RASTRO_MAGICA, 4) != 0 || cab->versao != RASTRO_VERSAO
+        || cab->tamRegistro != sizeof(RegistroRastro)) {
+        fprintf(stderr, "'%s' não é um rastro DQT1 desta versão.\n", caminho);
+        munmap(m, r->tamanho);
+        return -1;
+    }
+
+    size_t fimRegs = r->tamanho;
+    if (r->tamanho >= sizeof(CabecalhoRastro) + sizeof(RodapeRastro)) {
+        const RodapeRastro* rod = (const RodapeRastro*) (r->base + r->tamanho - sizeof(RodapeRastro));
+        if (memcmp(rod->magica, RASTRO_MAGICA_FIM, 4) == 0 && rod->offTextos >= sizeof(CabecalhoRastro)
+            && rod->offTextos <= r->tamanho - sizeof(RodapeRastro)
+            && rod->tamTextos <= r->tamanho - sizeof(RodapeRastro) - rod->offTextos) {
+            r->rodape = rod;
+            fimRegs = (size_t) rod->offTextos;
+        }
+    }
+    if (!r->rodape) fprintf(stderr, "Aviso: rastro sem rodapé (não encerrado); textos indisponíveis.\n");
+    r->regs = (const RegistroRastro*) (r->base + sizeof(CabecalhoRastro));
+    r->numRegs = (fimRegs - sizeof(CabecalhoRastro)) / sizeof(RegistroRastro);
+    if (!r->rodape) {
+        // a escrita pode ter parado no meio: fica até o último registro válido
+        size_t n = 0;
+        while (n < r->numRegs && r->regs[n].tipo >= RASTRO_RELOGIO && r->regs[n].tipo < RASTRO_NUM_TIPOS) n++;
+        r->numRegs = n;
+    }
+
+    r->tempos = (uint64_t*) malloc((r->numRegs ? r->numRegs : 1) * sizeof(uint64_t));
+    uint64_t* relogio = (uint64_t*) calloc(UINT16_MAX + 1, sizeof(uint64_t));    // thread -> ns
+    if (!r->tempos || !relogio) { fprintf(stderr, "Falha ao alocar os instantes do rastro.\n"); free(relogio); return -1; }
+    for (size_t i = 0; i < r->numRegs; ++i) {
+        const RegistroRastro* e = &r->regs[i];
+        if (e->tipo == RASTRO_RELOGIO) relogio[e->thread] = ((uint64_t) e->b << 32) | e->a;
+        r->tempos[i] = relogio[e->thread];
+    }
+    free(relogio);
+
+    if (r->rodape && r->rodape->numTextos) {
+        r->textos = (const char**) malloc(r->rodape->numTextos * sizeof(char*));
+        if (!r->textos) { fprintf(stderr, "Falha ao alocar os textos do rastro.\n"); return -1; }
+        const char* p = (const char*) r->base + r->rodape->offTextos;
+        const char* fim = p + r->rodape->tamTextos;
+        while (r->numTextos < r->rodape->numTextos && p < fim) {
+            const char* nul = memchr(p, '\0', (size_t) (fim - p));
+            if (!nul) break;
+            r->textos[r->numTextos++] = p;
+            p = nul + 1;
+        }
+    }
+    return 0;
+}
+
+static void fecharRastroLido(Rastro* r) {
+    free(r->tempos);
+    free(r->textos);
+    if (r->base) munmap((void*) r->base, r->tamanho);
+    memset(r, 0, sizeof(*r));
+}
+
+/* textoRastro() – texto do id (ou "#id" sem o rodapé) */
+static const char* textoRastro(const Rastro* r, uint32_t id, char* buf, size_t cap) {
+    if (id < r->numTextos) return r->textos[id];
+    snprintf(buf, cap, "#%u", id);
+    return buf;
+}
+
+static const char* salaRastro(const Rastro* r, const Cenario* c, const RegistroRastro* e, char* buf, size_t cap) {
+    if (e->tipo == RASTRO_SALA) return textoRastro(r, e->a, buf, cap);
+    if (c && e->a < c->cab->numSalas) return nomeSalaCenario(c, e->a);
+    snprintf(buf, cap, "sala %u", e->a);
+    return buf;
+}
+
+/* ------------------------------------------------------------
+ * ordenarPorTempo() – índices dos registros em ordem de tempo
+ * (merge sort de baixo para cima: estável, então empates mantêm
+ * a ordem do arquivo, e O(n log n) mesmo com milhões de registros)
+ * ------------------------------------------------------------ */
+static size_t* ordenarPorTempo(const Rastro* r) {
+    size_t n = r->numRegs;
+    size_t* ordem = (size_t*) malloc((n ? n : 1) * sizeof(size_t));
+    size_t* aux = (size_t*) malloc((n ? n : 1) * sizeof(size_t));
+    if (!ordem || !aux) { fprintf(stderr, "Falha ao alocar a ordem do rastro.\n"); exit(1); }
+    for (size_t i = 0; i < n; ++i) ordem[i] = i;
+    for (size_t largura = 1; largura < n; largura *= 2) {
+        for (size_t ini = 0; ini < n; ini += 2 * largura) {
+            size_t meio = ini + largura < n ? ini + largura : n;
+            size_t fim = ini + 2 * largura < n ? ini + 2 * largura : n;
+            size_t i = ini, j = meio, k = ini;
+            while (i < meio && j < fim)
+                aux[k++] = r->tempos[ordem[j]] < r->tempos[ordem[i]] ? ordem[j++] : ordem[i++];
+            while (i < meio) aux[k++] = ordem[i++];
+            while (j < fim)  aux[k++] = ordem[j++];
+        }
+        size_t* t = ordem; ordem = aux; aux = t;
+    }
+    free(aux);
+    return ordem;
+}
+
+/* ------------------------------------------------------------
+ * reproduzir() – um evento por linha: tempo (ms), thread, sessão
+ * ------------------------------------------------------------ */
+static void reproduzir(const Rastro* r, const Cenario* c, uint32_t sessao, FILE* out) {
+    size_t* ordem = ordenarPorTempo(r);
+    char buf[32];
+    for (size_t k = 0; k < r->numRegs; ++k) {
+        const RegistroRastro* e = &r->regs[ordem[k]];
+        if (e->tipo == RASTRO_RELOGIO || (sessao && e->sessao != sessao)) continue;
+        fprintf(out, "%12.6f  t%-3u s%-6u ", r->tempos[ordem[k]] / 1e6, e->thread, e->sessao);
+        switch (e->tipo) {
+            case RASTRO_FIM_SESSAO:
+                fprintf(out, "sessão encerrada: %u sala(s), %u pista(s)\n", e->a, e->b);
+                break;
+            case RASTRO_SALA:
+            case RASTRO_SALA_CENARIO:
+                fprintf(out, "sala      %s\n", salaRastro(r, c, e, buf, sizeof(buf)));
+                break;
+            case RASTRO_PISTA:
+                fprintf(out, "pista     %s%s\n", textoRastro(r, e->a, buf, sizeof(buf)), e->b ? "" : " (repetida)");
+                break;
+            case RASTRO_ACUSACAO:
+                if (e->b == SEM_INDICE) fprintf(out, "acusação  \"%s\" (suspeito desconhecido)\n", textoRastro(r, e->a, buf, sizeof(buf)));
+                else fprintf(out, "acusação  \"%s\" (suspeito #%u)\n", textoRastro(r, e->a, buf, sizeof(buf)), e->b);
+                break;
+            case RASTRO_VEREDITO:
+                fprintf(out, "veredito  %s, peso %u\n", e->b ? "SUSTENTADA" : "NAO_SUSTENTADA", e->a);
+                break;
+            default:
+                fprintf(out, "tipo %u desconhecido (%u, %u)\n", e->tipo, e->a, e->b);
+                break;
+        }
+    }
+    free(ordem);
+}
+
+/* escreverColuna() – texto alinhado em 'largura' colunas (conta
+ * caracteres UTF-8, não bytes) */
+static void escreverColuna(FILE* out, const char* s, int largura) {
+    int colunas = colunasUtf8(s);
+    fprintf(out, "  %s%*s", s, colunas < largura ? largura - colunas : 1, "");
+}
+
+/* Contagem por chave, para os mais frequentes do resumo: id de
+ * texto (pistas) ou (tipo << 32) | sala (salas) */
+typedef struct Contagem { uint64_t chave; uint64_t n; } Contagem;
+
+static int compararContagemDesc(const void* a, const void* b) {
+    const Contagem* x = (const Contagem*) a;
+    const Contagem* y = (const Contagem*) b;
+    if (x->n != y->n) return x->n < y->n ? 1 : -1;
+    return x->chave < y->chave ? -1 : x->chave > y->chave;
+}
+
+static int compararChave(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return x < y ? -1 : x > y;
+}
+
+/* maisFrequentes() – agrupa as chaves de 'v', guarda as k mais
+ * frequentes em 'top' e devolve quantas chaves distintas há */
+static size_t maisFrequentes(uint64_t* v, size_t n, Contagem* top, size_t k, size_t* usados) {
+    qsort(v, n, sizeof(uint64_t), compararChave);
+    size_t grupos = 0;
+    *usados = 0;
+    for (size_t i = 0; i < n; ) {
+        size_t j = i;
+        while (j < n && v[j] == v[i]) j++;
+        Contagem cnt = { v[i], j - i };
+        // mantém os k maiores em 'top' (k é pequeno)
+        if (*usados < k) top[(*usados)++] = cnt;
+        else if (compararContagemDesc(&cnt, &top[k - 1]) < 0) top[k - 1] = cnt;
+        qsort(top, *usados, sizeof(Contagem), compararContagemDesc);
+        grupos++;
+        i = j;
+    }
+    return grupos;
+}
+
+/* ------------------------------------------------------------
+ * resumir() – totais por tipo, sessões, vereditos, taxa de
+ * eventos e as salas e pistas mais frequentes
+ * ------------------------------------------------------------ */
+static void resumir(const Rastro* r, const Cenario* c, uint32_t sessao, FILE* out) {
+    static const char* const NOMES[RASTRO_NUM_TIPOS] = {
+        "?", "relógio", "fim de sessão", "sala", "sala (cenário)", "pista", "acusação", "veredito"
+    };
+    uint64_t porTipo[RASTRO_NUM_TIPOS + 1] = { 0 };
+    uint64_t salasSessao = 0, pistasSessao = 0, sessoesFechadas = 0, sustentadas = 0, repetidas = 0;
+    uint64_t tMin = UINT64_MAX, tMax = 0, n = 0;
+    uint32_t maxThread = 0;
+    uint64_t* salas = (uint64_t*) malloc((r->numRegs ? r->numRegs : 1) * sizeof(uint64_t));
+    uint64_t* pistas = (uint64_t*) malloc((r->numRegs ? r->numRegs : 1) * sizeof(uint64_t));
+    if (!salas || !pistas) { fprintf(stderr, "Falha ao alocar o resumo.\n"); exit(1); }
+    size_t numSalas = 0, numPistas = 0;
+
+    for (size_t i = 0; i < r->numRegs; ++i) {
+        const RegistroRastro* e = &r->regs[i];
+        if (e->tipo == RASTRO_RELOGIO || (sessao && e->sessao != sessao)) continue;
+        n++;
+        porTipo[e->tipo < RASTRO_NUM_TIPOS ? e->tipo : RASTRO_NUM_TIPOS]++;
+        if (r->tempos[i] < tMin) tMin = r->tempos[i];
+        if (r->tempos[i] > tMax) tMax = r->tempos[i];
+        if (e->thread > maxThread) maxThread = e->thread;
+        switch (e->tipo) {
+            case RASTRO_FIM_SESSAO: sessoesFechadas++; salasSessao += e->a; pistasSessao += e->b; break;
+            case RASTRO_SALA:
+            case RASTRO_SALA_CENARIO: salas[numSalas++] = ((uint64_t) e->tipo << 32) | e->a; break;
+            case RASTRO_PISTA: if (e->b) pistas[numPistas++] = e->a; else repetidas++; break;
+            case RASTRO_VEREDITO: sustentadas += e->b; break;
+            default: break;
+        }
+    }
+
+    double dur = n ? (tMax - tMin) / 1e9 : 0.0;
+    fprintf(out, "Registros:            %llu", (unsigned long long) n);
+    if (r->rodape) fprintf(out, " (%llu perdido(s) com o anel cheio)", (unsigned long long) r->rodape->perdidos);
+    fprintf(out, "\nThreads:              %u\n", n ? maxThread + 1 : 0);
+    fprintf(out, "Duração:              %.6f s", dur);
+    if (dur > 0) fprintf(out, " (%.0f eventos/s)", n / dur);
+    fprintf(out, "\n");
+    for (int t = 1; t <= RASTRO_NUM_TIPOS; ++t) {
+        if (!porTipo[t]) continue;
+        escreverColuna(out, t < RASTRO_NUM_TIPOS ? NOMES[t] : "desconhecido", 20);
+        fprintf(out, "%llu\n", (unsigned long long) porTipo[t]);
+    }
+    if (sessoesFechadas) {
+        fprintf(out, "Por sessão encerrada: %.2f sala(s), %.2f pista(s)\n",
+                (double) salasSessao / sessoesFechadas, (double) pistasSessao / sessoesFechadas);
+    }
+    fprintf(out, "Pistas repetidas:     %llu\n", (unsigned long long) repetidas);
+    if (porTipo[RASTRO_VEREDITO]) {
+        fprintf(out, "Vereditos:            %llu sustentado(s), %llu não\n", (unsigned long long) sustentadas,
+                (unsigned long long) (porTipo[RASTRO_VEREDITO] - sustentadas));
+    }
+
+    Contagem top[RESUMO_TOP];
+    size_t usados;
+    char buf[32];
+    size_t distintas = maisFrequentes(salas, numSalas, top, RESUMO_TOP, &usados);
+    if (distintas) fprintf(out, "Salas mais visitadas (%zu distintas):\n", distintas);
+    for (size_t i = 0; i < usados; ++i) {
+        RegistroRastro e = { (uint16_t) (top[i].chave >> 32), 0, 0, (uint32_t) top[i].chave, 0 };
+        escreverColuna(out, salaRastro(r, c, &e, buf, sizeof(buf)), 40);
+        fprintf(out, "%llu\n", (unsigned long long) top[i].n);
+    }
+    distintas = maisFrequentes(pistas, numPistas, top, RESUMO_TOP, &usados);
+    if (distintas) fprintf(out, "Pistas mais coletadas (%zu distintas):\n", distintas);
+    for (size_t i = 0; i < usados; ++i) {
+        escreverColuna(out, textoRastro(r, (uint32_t) top[i].chave, buf, sizeof(buf)), 40);
+        fprintf(out, "%llu\n", (unsigned long long) top[i].n);
+    }
+    free(salas);
+    free(pistas);
+}
+
+static void mostrarUso(const char* prog) {
+    fprintf(stderr,
+        "Uso: %s [opções] RASTRO\n"
+        "  --resumo            totais, sessões e mais frequentes, em vez dos eventos\n"
+        "  --sessao N          só os eventos da sessão N\n"
+        "  --cenario ARQ       cenário do rastro (para os nomes das salas)\n",
+        prog);
+}
+
+int main(int argc, char** argv) {
+    const char* caminho = NULL;
+    const char* arqCenario = NULL;
+    int resumo = 0;
+    unsigned long sessao = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--resumo") == 0) {
+            resumo = 1;
+        } else if (strcmp(argv[i], "--sessao") == 0 && i + 1 < argc) {
+            sessao = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--cenario") == 0 && i + 1 < argc) {
+            arqCenario = argv[++i];
+        } else if (argv[i][0] != '-' && !caminho) {
+            caminho = argv[i];
+        } else {
+            mostrarUso(argv[0]);
+            return 1;
+        }
+    }
+    if (!caminho) { mostrarUso(argv[0]); return 1; }
+
+    Rastro r;
+    if (abrirRastroLido(&r, caminho) != 0) return 1;
+    Cenario cenario;
+    if (arqCenario && abrirCenario(&cenario, arqCenario) != 0) { fecharRastroLido(&r); return 1; }
+
+    if (resumo) resumir(&r, arqCenario ? &cenario : NULL, (uint32_t) sessao, stdout);
+    else        reproduzir(&r, arqCenario ? &cenario : NULL, (uint32_t) sessao, stdout);
+
+    if (arqCenario) fecharCenario(&cenario);
+    fecharRastroLido(&r);
+    return 0;
+}
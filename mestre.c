@@ -1,97 +1,390 @@
 // detective_quest.c
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <errno.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <signal.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define SEM_INDICE 0xFFFFFFFFu      // índice/id ausente
+
+/* Mansão padrão pré-montada: o make gera build/mansao_padrao.h com
+   gerar_padrao (salas, textos e associações como tabelas estáticas).
+   Sem o arquivo, a mansão é montada em tempo de execução. */
+#if !defined(DETECTIVE_SEM_PADRAO) && defined(__has_include)
+#if __has_include("mansao_padrao.h")
+#include "mansao_padrao.h"
+#endif
+#endif
 
 /* ============================================================
-   ESTRUTURA 1: Mansão (Árvore Binária)
-   Cada sala tem APENAS nome; a pista é definida por lógica no código.
+   Instrumentação (compile com -DDQ_ESTATISTICAS para ativar)
+   Contadores do caminho quente: sondagens da hash, nós
+   percorridos na árvore de pistas, salas e pistas por sessão.
+   Cada thread conta na sua cópia local (_Thread_local), somada
+   ao total global por acumularEstatisticas(). Desativada, a
+   macro ESTAT() não gera código nenhum.
    ============================================================ */
-typedef struct Sala {
-    char nome[64];
-    struct Sala *esquerda, *direita;
-} Sala;
+#ifdef DQ_ESTATISTICAS
+typedef struct Estatisticas {
+    uint64_t buscasHash, sondagensHash, maxSondagem;
+    uint64_t insercoesHash, crescimentosHash;
+    uint64_t insercoesPista, nosPercorridosPista, pistasCriadas;
+    uint64_t sessoes, salasVisitadas, maxSalasSessao, pistasColetadas, maxPistasSessao;
+} Estatisticas;
 
-/* ------------------------------------------------------------
- * criarSala() – cria dinamicamente um cômodo
- * ------------------------------------------------------------ */
-Sala* criarSala(const char* nome) {
-    Sala* s = (Sala*) malloc(sizeof(Sala));
-    if (!s) { fprintf(stderr, "Falha ao alocar Sala.\n"); exit(1); }
-    strncpy(s->nome, nome, sizeof(s->nome)-1);
-    s->nome[sizeof(s->nome)-1] = '\0';
-    s->esquerda = s->direita = NULL;
-    return s;
+static _Thread_local Estatisticas estatLocal;
+static Estatisticas estatGlobal;
+static pthread_mutex_t estatTrava = PTHREAD_MUTEX_INITIALIZER;
+
+#define ESTAT(x) do { x; } while (0)
+#define ESTAT_MAX(campo, v) do { if ((uint64_t) (v) > estatLocal.campo) estatLocal.campo = (v); } while (0)
+
+/* acumularEstatisticas() – soma os contadores desta thread no total */
+void acumularEstatisticas(void) {
+#define SOMAR(c)  estatGlobal.c += estatLocal.c
+#define MAXIMO(c) if (estatLocal.c > estatGlobal.c) estatGlobal.c = estatLocal.c
+    pthread_mutex_lock(&estatTrava);
+    SOMAR(buscasHash); SOMAR(sondagensHash); MAXIMO(maxSondagem);
+    SOMAR(insercoesHash); SOMAR(crescimentosHash);
+    SOMAR(insercoesPista); SOMAR(nosPercorridosPista); SOMAR(pistasCriadas);
+    SOMAR(sessoes); SOMAR(salasVisitadas); MAXIMO(maxSalasSessao);
+    SOMAR(pistasColetadas); MAXIMO(maxPistasSessao);
+    pthread_mutex_unlock(&estatTrava);
+#undef SOMAR
+#undef MAXIMO
+    memset(&estatLocal, 0, sizeof(estatLocal));
 }
+#else
+#define ESTAT(x) do { } while (0)
+#define ESTAT_MAX(campo, v) do { } while (0)
+#endif
 
 /* ============================================================
-   ESTRUTURA 2: Pistas coletadas (BST)
-   Nós guardam apenas o texto da pista (string).
+   ESTRUTURA 0: Arena de memória
+   Os nós (salas, pistas, textos do pool) saem de blocos
+   contíguos com um simples avanço de ponteiro; não há free por
+   nó: a arena inteira é reiniciada ou liberada de uma vez.
    ============================================================ */
-typedef struct PistaNode {
-    char pista[128];
-    struct PistaNode *esq, *dir;
-} PistaNode;
+#define ARENA_BLOCO_MIN  (16u * 1024u)
+#define ARENA_ALINHAMENTO 16u
+
+typedef struct ArenaBloco {
+    struct ArenaBloco* ant;         // bloco alocado antes deste
+    size_t cap, usado;
+    unsigned char dados[];
+} ArenaBloco;
+
+typedef struct Arena {
+    ArenaBloco* atual;              // bloco corrente (o maior)
+    size_t bytesUsados;             // soma dos pedidos desde o último reset
+    size_t bytesReservados;         // soma das capacidades dos blocos vivos
+    size_t numAlocacoes;
+} Arena;
+
+void arenaIniciar(Arena* a) {
+    memset(a, 0, sizeof(*a));
+}
 
 /* ------------------------------------------------------------
- * criarPistaNode() – nó de pista para BST
+ * arenaAlocar() – devolve 'tam' bytes alinhados; quando o bloco
+ * corrente enche, abre outro com o dobro da capacidade
  * ------------------------------------------------------------ */
-PistaNode* criarPistaNode(const char* pista) {
-    PistaNode* n = (PistaNode*) malloc(sizeof(PistaNode));
-    if (!n) { fprintf(stderr, "Falha ao alocar PistaNode.\n"); exit(1); }
-    strncpy(n->pista, pista, sizeof(n->pista)-1);
-    n->pista[sizeof(n->pista)-1] = '\0';
-    n->esq = n->dir = NULL;
-    return n;
+void* arenaAlocar(Arena* a, size_t tam) {
+    size_t pedido = (tam + ARENA_ALINHAMENTO - 1) & ~(size_t)(ARENA_ALINHAMENTO - 1);
+    ArenaBloco* b = a->atual;
+    if (!b || b->cap - b->usado < pedido) {
+        size_t cap = b ? b->cap * 2 : ARENA_BLOCO_MIN;
+        while (cap < pedido) cap *= 2;
+        ArenaBloco* novo = (ArenaBloco*) malloc(sizeof(ArenaBloco) + cap);
+        if (!novo) { fprintf(stderr, "Falha ao alocar bloco da arena.\n"); exit(1); }
+        novo->ant = b;
+        novo->cap = cap;
+        novo->usado = 0;
+        a->atual = b = novo;
+        a->bytesReservados += cap;
+    }
+    void* p = b->dados + b->usado;
+    b->usado += pedido;
+    a->bytesUsados += tam;
+    a->numAlocacoes++;
+    return p;
 }
 
 /* ------------------------------------------------------------
- * inserirPista() – insere a pista coletada na BST (ordem alfabética)
- * Evita duplicatas: se já existir, não insere novamente.
+ * arenaResetar() – descarta tudo, mas mantém o maior bloco para
+ * que a próxima sessão reaproveite a memória sem novo malloc
  * ------------------------------------------------------------ */
-PistaNode* inserirPista(PistaNode* raiz, const char* pista) {
-    if (!pista || !*pista) return raiz;
-    if (raiz == NULL) return criarPistaNode(pista);
-
-    int cmp = strcmp(pista, raiz->pista);
-    if (cmp < 0) {
-        raiz->esq = inserirPista(raiz->esq, pista);
-    } else if (cmp > 0) {
-        raiz->dir = inserirPista(raiz->dir, pista);
-    } // igual: ignora duplicata
-    return raiz;
+void arenaResetar(Arena* a) {
+    ArenaBloco* b = a->atual;
+    if (!b) return;
+    ArenaBloco* velho = b->ant;
+    while (velho) {
+        ArenaBloco* ant = velho->ant;
+        free(velho);
+        velho = ant;
+    }
+    b->ant = NULL;
+    b->usado = 0;
+    a->bytesUsados = 0;
+    a->bytesReservados = b->cap;
+    a->numAlocacoes = 0;
+}
+
+void arenaLiberar(Arena* a) {
+    arenaResetar(a);
+    free(a->atual);
+    arenaIniciar(a);
+}
+
+/* ============================================================
+   Saída bufferizada
+   Formata em um buffer grande e reaproveitado e só chama write
+   quando ele enche (ou em descarregar()). Um bloco maior que o
+   buffer vai junto com o que está pendente num único writev.
+   No modo compacto, as listagens saem em formato de máquina
+   (uma linha por item, campos separados por tabulação).
+   ============================================================ */
+#define SAIDA_CAP_PADRAO (64u * 1024u)
+
+typedef struct Saida {
+    int    fd;
+    char*  buf;
+    size_t tam, cap;
+    int    compacto;
+    int    erro;            // 1 depois de uma falha de escrita
+} Saida;
+
+void saidaIniciar(Saida* s, int fd, size_t cap) {
+    s->fd = fd;
+    s->cap = cap ? cap : SAIDA_CAP_PADRAO;
+    s->buf = (char*) malloc(s->cap);
+    if (!s->buf) { fprintf(stderr, "Falha ao alocar buffer de saída.\n"); exit(1); }
+    s->tam = 0;
+    s->compacto = 0;
+    s->erro = 0;
+}
+
+/* escreverTudo() – writev até o fim, tratando escrita parcial e EINTR */
+static int escreverTudo(int fd, struct iovec* iov, int n) {
+    while (n > 0) {
+        ssize_t w = writev(fd, iov, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        while (n > 0 && (size_t) w >= iov->iov_len) { w -= (ssize_t) iov->iov_len; iov++; n--; }
+        if (n > 0) { iov->iov_base = (char*) iov->iov_base + w; iov->iov_len -= (size_t) w; }
+    }
+    return 0;
+}
+
+void descarregar(Saida* s) {
+    if (s->fd == STDOUT_FILENO) fflush(stdout);   // não embaralhar com printf
+    if (!s->tam) return;
+    struct iovec iov = { s->buf, s->tam };
+    if (!s->erro && escreverTudo(s->fd, &iov, 1) != 0) s->erro = 1;
+    s->tam = 0;
+}
+
+void saidaLiberar(Saida* s) {
+    descarregar(s);
+    free(s->buf);
+    s->buf = NULL;
+    s->cap = 0;
+}
+
+void escreverTexto(Saida* s, const char* p, size_t n) {
+    if (n <= s->cap - s->tam) {
+        memcpy(s->buf + s->tam, p, n);
+        s->tam += n;
+        return;
+    }
+    if (n >= s->cap) {
+        if (s->fd == STDOUT_FILENO) fflush(stdout);
+        struct iovec iov[2] = { { s->buf, s->tam }, { (void*) p, n } };
+        if (!s->erro && escreverTudo(s->fd, iov, 2) != 0) s->erro = 1;
+        s->tam = 0;
+        return;
+    }
+    descarregar(s);
+    memcpy(s->buf, p, n);
+    s->tam = n;
+}
+
+void escreverStr(Saida* s, const char* str) {
+    escreverTexto(s, str, strlen(str));
+}
+
+/* escrever() – printf para a Saida (formata direto no buffer) */
+void escrever(Saida* s, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(s->buf + s->tam, s->cap - s->tam, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if ((size_t) n < s->cap - s->tam) { s->tam += (size_t) n; return; }
+
+    descarregar(s);
+    if ((size_t) n < s->cap) {
+        va_start(ap, fmt);
+        vsnprintf(s->buf, s->cap, fmt, ap);
+        va_end(ap);
+        s->tam = (size_t) n;
+        return;
+    }
+    char* tmp = (char*) malloc((size_t) n + 1);
+    if (!tmp) { fprintf(stderr, "Falha ao alocar buffer de saída.\n"); exit(1); }
+    va_start(ap, fmt);
+    vsnprintf(tmp, (size_t) n + 1, fmt, ap);
+    va_end(ap);
+    escreverTexto(s, tmp, (size_t) n);
+    free(tmp);
 }
 
 /* ------------------------------------------------------------
- * exibirPistas() – imprime a BST em ordem alfabética
+ * saidaPadrao() – Saida única ligada ao stdout, descarregada
+ * automaticamente na saída do processo
  * ------------------------------------------------------------ */
-void exibirPistas(const PistaNode* r) {
-    if (!r) return;
-    exibirPistas(r->esq);
-    printf("- %s\n", r->pista);
-    exibirPistas(r->dir);
+static Saida saidaStdout;
+
+static void descarregarStdout(void) {
+    descarregar(&saidaStdout);
+}
+
+Saida* saidaPadrao(void) {
+    if (!saidaStdout.buf) {
+        saidaIniciar(&saidaStdout, STDOUT_FILENO, SAIDA_CAP_PADRAO);
+        atexit(descarregarStdout);
+    }
+    return &saidaStdout;
 }
 
 /* ============================================================
-   ESTRUTURA 3: Tabela Hash (pista -> suspeito)
-   Implementação com encadeamento separado (listas).
+   Pistas estáticas por sala (lógica no código)
+   Cada pista da mansão padrão tem um id = posição no catálogo.
+   A sala resolve seu id uma única vez, ao ser criada; durante o
+   jogo, achar a pista é só indexar TEXTO_PISTA.
    ============================================================ */
-typedef struct HashNode {
-    char chavePista[128];   // key
-    char suspeito[64];      // value
-    struct HashNode* prox;
-} HashNode;
+#define SEM_PISTA (-1)
 
-typedef struct HashTable {
-    HashNode** buckets;
-    size_t capacidade;
-} HashTable;
+enum {
+    PISTA_PEGADA, PISTA_COPO, PISTA_FACA, PISTA_LIVRO,
+    PISTA_TERRA, PISTA_BILHETE, PISTA_CHAVE,
+    NUM_PISTAS_PADRAO
+};
+
+static const char* const TEXTO_PISTA[NUM_PISTAS_PADRAO] = {
+    [PISTA_PEGADA]  = "Pegada com lama no tapete",
+    [PISTA_COPO]    = "Copo quebrado no chão",
+    [PISTA_FACA]    = "Faca com marcas recentes",
+    [PISTA_LIVRO]   = "Livro raro fora da estante",
+    [PISTA_TERRA]   = "Terra revirada junto ao canteiro",
+    [PISTA_BILHETE] = "Bilhete rasgado sob a cama",
+    [PISTA_CHAVE]   = "Chave antiga com ferrugem",
+};
+
+/* ------------------------------------------------------------
+ * pistaIdPorSala() – mapeamento "fixo" sala -> id da pista
+ * (usado só na criação das salas; pode ajustar conforme a história)
+ * ------------------------------------------------------------ */
+int pistaIdPorSala(const char* nomeSala) {
+    if (strcmp(nomeSala, "Hall de Entrada") == 0)  return PISTA_PEGADA;
+    if (strcmp(nomeSala, "Sala de Estar") == 0)    return PISTA_COPO;
+    if (strcmp(nomeSala, "Cozinha") == 0)          return PISTA_FACA;
+    if (strcmp(nomeSala, "Biblioteca") == 0)       return PISTA_LIVRO;
+    if (strcmp(nomeSala, "Jardim") == 0)           return PISTA_TERRA;
+    if (strcmp(nomeSala, "Quarto") == 0)           return PISTA_BILHETE;
+    if (strcmp(nomeSala, "Adega") == 0)            return PISTA_CHAVE;
+    // sem pista explícita
+    return SEM_PISTA;
+}
+
+/* textoPista() – texto da pista pelo id ("" se não houver) */
+static inline const char* textoPista(int id) {
+    return (id >= 0 && id < NUM_PISTAS_PADRAO) ? TEXTO_PISTA[id] : "";
+}
+
+/* ============================================================
+   Pool de textos internados
+   Cada texto distinto (nome de sala, pista, suspeito) é copiado
+   uma única vez e ganha um id de 32 bits sequencial; salas, nós
+   de pista e associações guardam só o id. Igualdade vira
+   comparação de inteiros e nenhum texto é truncado.
+   Leituras não travam: os textos e os blocos id -> texto nunca
+   mudam de lugar, e o índice (endereçamento aberto, sondagem
+   linear) é trocado por um novo quando cresce – as versões
+   antigas só saem em liberarTextos(). Textos novos entram sob
+   um mutex.
+   Com a mansão pré-montada, o pool já nasce com os textos dela
+   (bloco e índice estáticos, sem colisão no índice): os ids das
+   tabelas geradas valem desde o início, sem malloc nem hash.
+   ============================================================ */
+#define POOL_BLOCO_BITS 12
+#define POOL_BLOCO      (1u << POOL_BLOCO_BITS)     // ids por bloco
+#define POOL_MAX_BLOCOS (1u << 16)                  // até 2^28 textos
+#define POOL_CARGA_MAX_NUM 7    // fator de carga máximo do índice = 7/10
+#define POOL_CARGA_MAX_DEN 10
+
+typedef struct EntradaTexto {
+    const char* texto;
+    uint32_t tam;
+    uint32_t hash;          // hash_rapido() do texto
+} EntradaTexto;
+
+typedef struct IndiceTextos {
+    struct IndiceTextos* anterior;  // versão substituída (liberada no fim)
+    size_t capacidade;              // sempre potência de 2
+    _Atomic uint32_t pos[];         // id + 1 (0 = vazio)
+} IndiceTextos;
+
+typedef struct PoolTextos {
+    EntradaTexto* blocos[POOL_MAX_BLOCOS];
+    _Atomic(IndiceTextos*) indice;
+    _Atomic uint32_t num;
+    Arena textos;
+    pthread_mutex_t trava;
+} PoolTextos;
+
+#ifdef MANSAO_PADRAO_GERADA
+static EntradaTexto textosEmbutidos[POOL_BLOCO] = PADRAO_TEXTOS;
+static IndiceTextos indiceEmbutido = { NULL, PADRAO_CAP_INDICE_TEXTOS, PADRAO_INDICE_TEXTOS };
+static PoolTextos poolTextos = {
+    .blocos = { textosEmbutidos },
+    .indice = &indiceEmbutido,
+    .num = PADRAO_NUM_TEXTOS,
+    .trava = PTHREAD_MUTEX_INITIALIZER,
+};
+#else
+static PoolTextos poolTextos = { .trava = PTHREAD_MUTEX_INITIALIZER };
+#endif
 
 /* ------------------------------------------------------------
- * hash_djb2() – hash simples para strings
+ * hash_djb2() – hash simples para strings (byte a byte); fica
+ * como referência de comparação para hash_rapido()
  * ------------------------------------------------------------ */
-static unsigned long hash_djb2(const char* str) {
+unsigned long hash_djb2(const char* str) {
     unsigned long h = 5381;
     int c;
     while ((c = (unsigned char)*str++)) {
@@ -101,246 +394,503 @@ static unsigned long hash_djb2(const char* str) {
 }
 
 /* ------------------------------------------------------------
- * criarHash() – cria tabela hash com capacidade dada
+ * hash_rapido() – consome 8 bytes por vez e mistura com
+ * multiplicação 64x64; nunca devolve 0 (reservado para vazio)
  * ------------------------------------------------------------ */
-HashTable* criarHash(size_t capacidade) {
-    HashTable* ht = (HashTable*) malloc(sizeof(HashTable));
-    if (!ht) { fprintf(stderr, "Falha ao alocar HashTable.\n"); exit(1); }
-    ht->capacidade = capacidade;
-    ht->buckets = (HashNode**) calloc(capacidade, sizeof(HashNode*));
-    if (!ht->buckets) { fprintf(stderr, "Falha ao alocar buckets.\n"); exit(1); }
-    return ht;
+static inline uint64_t misturar64(uint64_t x) {
+    x ^= x >> 32;
+    x *= 0xd6e8feb86659fd93ull;
+    x ^= x >> 32;
+    return x;
 }
 
-/* ------------------------------------------------------------
- * inserirNaHash() – insere associação pista/suspeito na hash
- * (se a chave já existir, atualiza o suspeito)
- * ------------------------------------------------------------ */
-void inserirNaHash(HashTable* ht, const char* pista, const char* suspeito) {
-    if (!ht || !pista || !suspeito) return;
-    unsigned long h = hash_djb2(pista) % ht->capacidade;
-    HashNode* cur = ht->buckets[h];
-
-    // Atualiza se já existe
-    while (cur) {
-        if (strcmp(cur->chavePista, pista) == 0) {
-            strncpy(cur->suspeito, suspeito, sizeof(cur->suspeito)-1);
-            cur->suspeito[sizeof(cur->suspeito)-1] = '\0';
-            return;
-        }
-        cur = cur->prox;
+uint32_t hash_rapido(const char* s, size_t n) {
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ (n * 0xff51afd7ed558ccdull);
+    while (n >= 8) {
+        uint64_t w;
+        memcpy(&w, s, 8);
+        h = misturar64(h ^ w) * 0x9e3779b97f4a7c15ull;
+        s += 8; n -= 8;
     }
+    uint64_t w = 0;
+    memcpy(&w, s, n);
+    // os bits altos do produto dependem de todos os bits de entrada;
+    // os baixos (que escolhem a posição no índice) não
+    h = misturar64(h ^ w) * 0x9e3779b97f4a7c15ull;
+    uint32_t r = (uint32_t) (h >> 32);
+    return r ? r : 1;
+}
 
-    // Insere novo
-    HashNode* novo = (HashNode*) malloc(sizeof(HashNode));
-    if (!novo) { fprintf(stderr, "Falha ao alocar HashNode.\n"); exit(1); }
-    strncpy(novo->chavePista, pista, sizeof(novo->chavePista)-1);
-    novo->chavePista[sizeof(novo->chavePista)-1] = '\0';
-    strncpy(novo->suspeito, suspeito, sizeof(novo->suspeito)-1);
-    novo->suspeito[sizeof(novo->suspeito)-1] = '\0';
-    novo->prox = ht->buckets[h];
-    ht->buckets[h] = novo;
+static inline const EntradaTexto* entradaTexto(uint32_t id) {
+    return &poolTextos.blocos[id >> POOL_BLOCO_BITS][id & (POOL_BLOCO - 1)];
 }
 
-/* ------------------------------------------------------------
- * encontrarSuspeito() – retorna suspeito associado à pista (ou "")
- * ------------------------------------------------------------ */
-const char* encontrarSuspeito(HashTable* ht, const char* pista) {
-    if (!ht || !pista) return "";
-    unsigned long h = hash_djb2(pista) % ht->capacidade;
-    for (HashNode* cur = ht->buckets[h]; cur; cur = cur->prox) {
-        if (strcmp(cur->chavePista, pista) == 0) {
-            return cur->suspeito;
-        }
-    }
-    return "";
+/* textoDoId() – texto de um id do pool ("" para SEM_INDICE) */
+const char* textoDoId(uint32_t id) {
+    return id == SEM_INDICE ? "" : entradaTexto(id)->texto;
+}
+
+uint32_t numTextos(void) {
+    return atomic_load_explicit(&poolTextos.num, memory_order_acquire);
 }
 
 /* ------------------------------------------------------------
- * util: lower-case comparador de strings (case-insensitive)
+ * procurarNoIndice() – id do texto, ou SEM_INDICE se ele ainda
+ * não foi internado
  * ------------------------------------------------------------ */
-int str_ieq(const char* a, const char* b) {
-    if (!a || !b) return 0;
-    while (*a && *b) {
-        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return 0;
-        a++; b++;
+static uint32_t procurarNoIndice(IndiceTextos* ix, const char* s, size_t n, uint32_t h) {
+    if (!ix) return SEM_INDICE;
+    size_t mascara = ix->capacidade - 1;
+    size_t i = h & mascara;
+#ifdef DQ_ESTATISTICAS
+    uint64_t sondagens = 1;
+    estatLocal.buscasHash++;
+#define FIM_BUSCA(id) do { estatLocal.sondagensHash += sondagens; \
+                           ESTAT_MAX(maxSondagem, sondagens); return (id); } while (0)
+#else
+#define FIM_BUSCA(id) return (id)
+#endif
+    for (;;) {
+        uint32_t v = atomic_load_explicit(&ix->pos[i], memory_order_acquire);
+        if (!v) FIM_BUSCA(SEM_INDICE);
+        const EntradaTexto* e = entradaTexto(v - 1);
+        if (e->hash == h && e->tam == n && memcmp(e->texto, s, n) == 0) FIM_BUSCA(v - 1);
+        i = (i + 1) & mascara;
+        ESTAT(sondagens++);
     }
-    return *a == '\0' && *b == '\0';
+#undef FIM_BUSCA
+}
+
+static void posicionarNoIndice(IndiceTextos* ix, uint32_t id, uint32_t h) {
+    size_t mascara = ix->capacidade - 1;
+    size_t i = h & mascara;
+    while (atomic_load_explicit(&ix->pos[i], memory_order_relaxed)) i = (i + 1) & mascara;
+    atomic_store_explicit(&ix->pos[i], id + 1, memory_order_release);
 }
 
 /* ------------------------------------------------------------
- * contarPistasParaSuspeito() – varre a BST e conta quantas
- * pistas mapeiam para o suspeito acusado (usando a hash)
+ * crescerIndice() – monta um índice com o dobro da capacidade
+ * (usando o hash guardado; nenhum texto é re-hasheado) e o
+ * publica. Quem ainda lê o antigo continua achando o que já
+ * estava lá.
  * ------------------------------------------------------------ */
-int contarPistasParaSuspeito(const PistaNode* r, HashTable* ht, const char* acusado) {
-    if (!r) return 0;
-    int left = contarPistasParaSuspeito(r->esq, ht, acusado);
-    int mid  = str_ieq(encontrarSuspeito(ht, r->pista), acusado) ? 1 : 0;
-    int right= contarPistasParaSuspeito(r->dir, ht, acusado);
-    return left + mid + right;
+static IndiceTextos* crescerIndice(IndiceTextos* velho, uint32_t num) {
+    size_t cap = velho ? velho->capacidade * 2 : 64;
+    IndiceTextos* ix = (IndiceTextos*) calloc(1, sizeof(IndiceTextos) + cap * sizeof(uint32_t));
+    if (!ix) { fprintf(stderr, "Falha ao alocar índice de textos.\n"); exit(1); }
+    ix->anterior = velho;
+    ix->capacidade = cap;
+    for (uint32_t id = 0; id < num; ++id) posicionarNoIndice(ix, id, entradaTexto(id)->hash);
+    atomic_store_explicit(&poolTextos.indice, ix, memory_order_release);
+    ESTAT(estatLocal.crescimentosHash++);
+    return ix;
+}
+
+/* buscarTexto() – id de um texto já internado, ou SEM_INDICE */
+uint32_t buscarTexto(const char* s, size_t n) {
+    IndiceTextos* ix = atomic_load_explicit(&poolTextos.indice, memory_order_acquire);
+    return procurarNoIndice(ix, s, n, hash_rapido(s, n));
+}
+
+uint32_t buscarStr(const char* s) {
+    return buscarTexto(s, strlen(s));
 }
 
 /* ------------------------------------------------------------
- * liberarBST() / liberarHash() / liberarMansao()
+ * internarTexto() – id do texto, copiando-o para o pool se for
+ * novo (só esse caso trava)
  * ------------------------------------------------------------ */
-void liberarBST(PistaNode* r) {
-    if (!r) return;
-    liberarBST(r->esq);
-    liberarBST(r->dir);
-    free(r);
-}
+uint32_t internarTexto(const char* s, size_t n) {
+    uint32_t h = hash_rapido(s, n);
+    uint32_t id = procurarNoIndice(atomic_load_explicit(&poolTextos.indice, memory_order_acquire), s, n, h);
+    if (id != SEM_INDICE) return id;
 
-void liberarHash(HashTable* ht) {
-    if (!ht) return;
-    for (size_t i = 0; i < ht->capacidade; ++i) {
-        HashNode* cur = ht->buckets[i];
-        while (cur) {
-            HashNode* nxt = cur->prox;
-            free(cur);
-            cur = nxt;
+    pthread_mutex_lock(&poolTextos.trava);
+    IndiceTextos* ix = atomic_load_explicit(&poolTextos.indice, memory_order_relaxed);
+    id = procurarNoIndice(ix, s, n, h);     // outra thread pode ter inserido antes
+    if (id == SEM_INDICE) {
+        id = atomic_load_explicit(&poolTextos.num, memory_order_relaxed);
+        if (id >= POOL_BLOCO * POOL_MAX_BLOCOS) { fprintf(stderr, "Pool de textos cheio.\n"); exit(1); }
+        EntradaTexto** bloco = &poolTextos.blocos[id >> POOL_BLOCO_BITS];
+        if (!*bloco) {
+            *bloco = (EntradaTexto*) malloc(POOL_BLOCO * sizeof(EntradaTexto));
+            if (!*bloco) { fprintf(stderr, "Falha ao alocar bloco de textos.\n"); exit(1); }
         }
+        char* c = (char*) arenaAlocar(&poolTextos.textos, n + 1);
+        memcpy(c, s, n);
+        c[n] = '\0';
+        (*bloco)[id & (POOL_BLOCO - 1)] = (EntradaTexto) { c, (uint32_t) n, h };
+        atomic_store_explicit(&poolTextos.num, id + 1, memory_order_release);
+        if (!ix || (size_t) (id + 1) * POOL_CARGA_MAX_DEN > ix->capacidade * POOL_CARGA_MAX_NUM)
+            crescerIndice(ix, id + 1);
+        else
+            posicionarNoIndice(ix, id, h);
     }
-    free(ht->buckets);
-    free(ht);
+    pthread_mutex_unlock(&poolTextos.trava);
+    return id;
 }
 
-void liberarMansao(Sala* r) {
-    if (!r) return;
-    liberarMansao(r->esquerda);
-    liberarMansao(r->direita);
-    free(r);
+uint32_t internarStr(const char* s) {
+    return internarTexto(s, strlen(s));
 }
 
-/* ============================================================
-   Pistas estáticas por sala (lógica no código)
-   ============================================================ */
-const char* pistaPorSala(const char* nomeSala) {
-    // mapeamento "fixo" (pode ajustar conforme a história)
-    if (strcmp(nomeSala, "Hall de Entrada") == 0)  return "Pegada com lama no tapete";
-    if (strcmp(nomeSala, "Sala de Estar") == 0)    return "Copo quebrado no chão";
-    if (strcmp(nomeSala, "Cozinha") == 0)          return "Faca com marcas recentes";
-    if (strcmp(nomeSala, "Biblioteca") == 0)       return "Livro raro fora da estante";
-    if (strcmp(nomeSala, "Jardim") == 0)           return "Terra revirada junto ao canteiro";
-    if (strcmp(nomeSala, "Quarto") == 0)           return "Bilhete rasgado sob a cama";
-    if (strcmp(nomeSala, "Adega") == 0)            return "Chave antiga com ferrugem";
-    // sem pista explícita
-    return "";
+/* ------------------------------------------------------------
+ * liberarTextos() – devolve toda a memória do pool; os ids e
+ * ponteiros entregues antes deixam de valer (menos os textos
+ * embutidos, que voltam a ser os únicos do pool)
+ * ------------------------------------------------------------ */
+void liberarTextos(void) {
+#ifdef MANSAO_PADRAO_GERADA
+    EntradaTexto* embutidos = textosEmbutidos;
+    IndiceTextos* ixEmbutido = &indiceEmbutido;
+#else
+    EntradaTexto* embutidos = NULL;
+    IndiceTextos* ixEmbutido = NULL;
+#endif
+    IndiceTextos* ix = atomic_load(&poolTextos.indice);
+    while (ix) {
+        IndiceTextos* ant = ix->anterior;
+        if (ix != ixEmbutido) free(ix);
+        ix = ant;
+    }
+    for (uint32_t b = 0; b < POOL_MAX_BLOCOS && poolTextos.blocos[b]; ++b) {
+        if (poolTextos.blocos[b] != embutidos) free(poolTextos.blocos[b]);
+        poolTextos.blocos[b] = NULL;
+    }
+    arenaLiberar(&poolTextos.textos);
+    atomic_store(&poolTextos.indice, NULL);
+    atomic_store(&poolTextos.num, 0);
+#ifdef MANSAO_PADRAO_GERADA
+    // textos internados depois podem ter entrado no índice estático
+    for (size_t i = 0; i < indiceEmbutido.capacidade; ++i) atomic_store(&indiceEmbutido.pos[i], 0);
+    for (uint32_t id = 0; id < PADRAO_NUM_TEXTOS; ++id) posicionarNoIndice(&indiceEmbutido, id, textosEmbutidos[id].hash);
+    indiceEmbutido.anterior = NULL;
+    poolTextos.blocos[0] = textosEmbutidos;
+    atomic_store(&poolTextos.indice, &indiceEmbutido);
+    atomic_store(&poolTextos.num, PADRAO_NUM_TEXTOS);
+#endif
 }
 
 /* ============================================================
-   Popular a tabela hash (pista -> suspeito)
-   (feito uma vez no início)
+   Rastro binário de sessões (mestre --rastro ARQ)
+   Registros de tamanho fixo (salas visitadas, pistas coletadas,
+   acusação e veredito, fim de sessão com o resumo). Cada thread
+   escreve no seu próprio anel (um produtor, um consumidor, sem
+   trava); uma thread escritora esvazia os anéis no arquivo a
+   cada milissegundo. Anel cheio descarta o registro e conta a
+   perda, em vez de segurar o jogo.
+   Desligado, RASTRO() custa um teste de uma variável global.
+   Ligado, o jogo não lê o relógio: a escritora o lê uma vez por
+   passada e, antes dos registros de cada anel, grava um
+   RASTRO_RELOGIO com o instante da passada anterior (tudo o que
+   ela esvazia aconteceu depois dele). Os eventos valem o último
+   relógio da sua thread: erro de uma pausa da escritora (~1 ms),
+   e numa rajada vários eventos saem com o mesmo instante.
+   Uma sessão só ganha número no primeiro evento; o começo dela
+   é o instante do primeiro registro e o fim vai num único
+   RASTRO_FIM_SESSAO, com o resumo (sessões vazias não aparecem).
+
+   Layout do arquivo (little-endian):
+     CabecalhoRastro | RegistroRastro[] | textos do pool ('\0')
+     | preenchimento até 8 | RodapeRastro
+   Os registros saem na ordem em que foram esvaziados (por
+   thread, em ordem de tempo); o rodapé só existe se o rastro foi
+   encerrado, e os ids de texto dos registros indexam os textos.
+   Salas de cenário vão pelo índice no arquivo do cenário.
    ============================================================ */
-void carregarAssociacoes(HashTable* ht) {
-    // Exemplo de relações (ajuste à narrativa):
-    inserirNaHash(ht, "Pegada com lama no tapete",        "Jardineiro");
-    inserirNaHash(ht, "Copo quebrado no chão",            "Mordomo");
-    inserirNaHash(ht, "Faca com marcas recentes",         "Cozinheira");
-    inserirNaHash(ht, "Livro raro fora da estante",       "Bibliotecária");
-    inserirNaHash(ht, "Terra revirada junto ao canteiro", "Jardineiro");
-    inserirNaHash(ht, "Bilhete rasgado sob a cama",       "Mordomo");
-    inserirNaHash(ht, "Chave antiga com ferrugem",        "Bibliotecária");
+#define RASTRO_MAGICA      "DQT1"
+#define RASTRO_MAGICA_FIM  "DQTF"
+#define RASTRO_VERSAO      2u
+#define RASTRO_ANEL        (1u << 16)   // registros por thread (potência de 2)
+#define RASTRO_BUFFER      (1u << 20)
+#define RASTRO_ESPERA_NS   1000000L     // pausa da escritora entre passadas
+#define RASTRO_LOTE_SESSOES 256u        // números de sessão reservados por vez, por thread
+
+typedef enum {
+    RASTRO_RELOGIO = 1,     // a, b = ns desde a abertura (32 bits baixos, altos), para a thread
+    RASTRO_FIM_SESSAO,      // a = salas visitadas, b = pistas coletadas
+    RASTRO_SALA,            // a = id do nome da sala
+    RASTRO_SALA_CENARIO,    // a = índice da sala no cenário
+    RASTRO_PISTA,           // a = id do texto da pista, b = 1 se nova
+    RASTRO_ACUSACAO,        // a = id do nome acusado, b = id do suspeito (ou SEM_INDICE)
+    RASTRO_VEREDITO,        // a = peso das pistas contra o acusado, b = 1 se sustentada
+    RASTRO_NUM_TIPOS
+} TipoRastro;
+
+typedef struct CabecalhoRastro {
+    char     magica[4];
+    uint32_t versao;
+    uint32_t tamRegistro;
+    uint32_t reservado;
+    uint64_t epoca;                 // CLOCK_REALTIME da abertura, em ns
+} CabecalhoRastro;
+
+typedef struct RegistroRastro {
+    uint16_t tipo;
+    uint16_t thread;
+    uint32_t sessao;                // 0 = fora de sessão (e no RASTRO_RELOGIO)
+    uint32_t a, b;
+} RegistroRastro;
+
+typedef struct RodapeRastro {
+    char     magica[4];
+    uint32_t numTextos;
+    uint64_t offTextos, tamTextos;
+    uint64_t perdidos;              // registros descartados com o anel cheio
+    uint32_t numThreads;
+    uint32_t reservado;
+} RodapeRastro;
+
+_Static_assert(sizeof(CabecalhoRastro) == 24, "cabeçalho do rastro deve ter 24 bytes");
+_Static_assert(sizeof(RegistroRastro) == 16, "registro do rastro deve ter 16 bytes");
+_Static_assert(sizeof(RodapeRastro) == 40, "rodapé do rastro deve ter 40 bytes");
+
+typedef struct AnelRastro {
+    _Alignas(64) _Atomic uint64_t cabeca;   // próximo a escrever (só a thread dona avança)
+    _Alignas(64) _Atomic uint64_t cauda;    // próximo a gravar (só a escritora avança)
+    _Alignas(64) uint64_t caudaVista;       // cópia da dona; relida só quando parece cheio
+    _Atomic uint64_t perdidos;
+    uint16_t thread;
+    struct AnelRastro* prox;
+    RegistroRastro reg[RASTRO_ANEL];
+} AnelRastro;
+
+static struct {
+    FILE*      f;
+    int        ok;
+    uint64_t   inicio;                      // CLOCK_MONOTONIC da abertura, em ns
+    uint64_t   passada;                     // CLOCK_MONOTONIC do começo da última passada
+    _Atomic(AnelRastro*) aneis;             // lista (push com CAS)
+    _Atomic uint32_t numThreads;
+    _Atomic uint32_t proximaSessao;
+    _Atomic int      parar;
+    pthread_t  escritora;
+} rastro;
+
+static int rastroLigado;                    // escrito antes de qualquer thread
+static uint32_t rastroGeracao;              // +1 a cada abrirRastro(), idem
+static _Thread_local AnelRastro* anelLocal;
+static _Thread_local uint32_t sessaoLocal, fimSessaoLocal;  // lote de números de sessão
+static _Thread_local uint32_t geracaoLocal; // rastro a que anelLocal e o lote pertencem
+
+#define RASTRO(tipo, sessao, a, b) do { if (rastroLigado) registrarRastro((tipo), (sessao), (a), (b)); } while (0)
+
+static inline uint64_t nsMonotonico(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
 }
 
-/* ============================================================
-   Interface / Fluxo do jogo
-   ============================================================ */
+/* renovarRastroLocal() – esquece o anel e o lote de sessões de um
+ * rastro já encerrado (liberados por encerrarRastro()), para uma
+ * thread que sobreviveu a ele */
+static void renovarRastroLocal(void) {
+    anelLocal = NULL;
+    sessaoLocal = fimSessaoLocal = 0;
+    geracaoLocal = rastroGeracao;
+}
+
+/* novoAnel() – anel da thread atual, criado no primeiro registro */
+static AnelRastro* novoAnel(void) {
+    AnelRastro* a = (AnelRastro*) aligned_alloc(64, sizeof(AnelRastro));
+    if (!a) return NULL;
+    memset(a, 0, offsetof(AnelRastro, reg));
+    a->thread = (uint16_t) atomic_fetch_add(&rastro.numThreads, 1);
+    AnelRastro* topo = atomic_load(&rastro.aneis);
+    do { a->prox = topo; } while (!atomic_compare_exchange_weak(&rastro.aneis, &topo, a));
+    return anelLocal = a;
+}
 
 /* ------------------------------------------------------------
- * explorarSalas() – navega pela árvore e ativa o sistema de pistas
- * - a cada sala visitada: mostra a sala, revela a pista (se houver)
- *   e insere na BST de pistas coletadas.
- * - navegação: (e) esquerda, (d) direita, (s) sair
+ * registrarRastro() – acrescenta um registro ao anel da thread
+ * (inline: é o único custo do rastro no caminho do jogo)
  * ------------------------------------------------------------ */
-void explorarSalas(Sala* inicio, PistaNode** pistasBST) {
-    Sala* atual = inicio;
-    char op;
-
-    while (atual) {
-        printf("\nVocê está em: %s\n", atual->nome);
-
-        const char* pista = pistaPorSala(atual->nome);
-        if (pista && *pista) {
-            printf("Pista encontrada: %s\n", pista);
-            *pistasBST = inserirPista(*pistasBST, pista);
-        } else {
-            printf("Nenhuma pista aqui.\n");
+static inline void registrarRastro(TipoRastro tipo, uint32_t sessao, uint32_t a, uint32_t b) {
+    if (geracaoLocal != rastroGeracao) renovarRastroLocal();
+    AnelRastro* anel = anelLocal ? anelLocal : novoAnel();
+    if (!anel) return;
+    uint64_t h = atomic_load_explicit(&anel->cabeca, memory_order_relaxed);
+    if (h - anel->caudaVista == RASTRO_ANEL) {
+        anel->caudaVista = atomic_load_explicit(&anel->cauda, memory_order_acquire);
+        if (h - anel->caudaVista == RASTRO_ANEL) {
+            atomic_fetch_add_explicit(&anel->perdidos, 1, memory_order_relaxed);
+            return;
         }
+    }
+    RegistroRastro* r = &anel->reg[h & (RASTRO_ANEL - 1)];
+    r->tipo = (uint16_t) tipo;
+    r->thread = anel->thread;
+    r->sessao = sessao;
+    r->a = a;
+    r->b = b;
+    atomic_store_explicit(&anel->cabeca, h + 1, memory_order_release);
+}
 
-        printf("\nEscolha um caminho:\n");
-        if (atual->esquerda) printf(" (e) Esquerda -> %s\n", atual->esquerda->nome);
-        if (atual->direita)  printf(" (d) Direita  -> %s\n", atual->direita->nome);
-        printf(" (s) Sair da exploração\n");
-        printf("Sua escolha: ");
-        if (scanf(" %c", &op) != 1) { printf("Entrada inválida.\n"); return; }
+/* novaSessaoRastro() – número (a partir de 1, único entre as
+ * threads) de uma sessão com algo a registrar; cada thread
+ * reserva um lote por vez, para não disputar o contador */
+uint32_t novaSessaoRastro(void) {
+    if (geracaoLocal != rastroGeracao) renovarRastroLocal();
+    if (sessaoLocal == fimSessaoLocal) {
+        sessaoLocal = atomic_fetch_add_explicit(&rastro.proximaSessao, RASTRO_LOTE_SESSOES,
+                                                memory_order_relaxed) + 1;
+        fimSessaoLocal = sessaoLocal + RASTRO_LOTE_SESSOES;
+    }
+    return sessaoLocal++;
+}
 
-        if (op == 'e' && atual->esquerda) {
-            atual = atual->esquerda;
-        } else if (op == 'd' && atual->direita) {
-            atual = atual->direita;
-        } else if (op == 's') {
-            printf("\nExploração encerrada pelo jogador.\n");
-            break;
-        } else {
-            printf("Opção inválida, tente novamente.\n");
+/* esvaziarAneis() – grava o que há em cada anel, precedido do
+ * relógio da thread (até a cauda andar, os registros são só da
+ * escritora); retorna o maior número de registros tirado de um
+ * só anel */
+static uint64_t esvaziarAneis(void) {
+    uint64_t maior = 0;
+    uint64_t ns = rastro.passada - rastro.inicio;  // tudo o que falta gravar veio depois dela
+    rastro.passada = nsMonotonico();
+    for (AnelRastro* a = atomic_load(&rastro.aneis); a; a = a->prox) {
+        uint64_t t = atomic_load_explicit(&a->cauda, memory_order_relaxed);
+        uint64_t h = atomic_load_explicit(&a->cabeca, memory_order_acquire);
+        if (t == h) continue;
+        RegistroRastro relogio = { RASTRO_RELOGIO, a->thread, 0, (uint32_t) ns, (uint32_t) (ns >> 32) };
+        if (rastro.ok && fwrite(&relogio, sizeof(relogio), 1, rastro.f) != 1) rastro.ok = 0;
+        while (t < h) {
+            uint64_t ini = t & (RASTRO_ANEL - 1);
+            uint64_t n = h - t < RASTRO_ANEL - ini ? h - t : RASTRO_ANEL - ini;
+            if (rastro.ok && fwrite(&a->reg[ini], sizeof(RegistroRastro), n, rastro.f) != n) rastro.ok = 0;
+            t += n;
         }
+        uint64_t tirados = t - atomic_load_explicit(&a->cauda, memory_order_relaxed);
+        if (tirados > maior) maior = tirados;
+        atomic_store_explicit(&a->cauda, t, memory_order_release);
     }
+    return maior;
+}
+
+/* escreverRastro() – esvazia os anéis a cada pausa; só emenda uma
+ * passada na outra se algum anel chegou à metade (esvaziar a cada
+ * registro disputaria a CPU com as threads do jogo) */
+static void* escreverRastro(void* arg) {
+    (void) arg;
+    struct timespec espera = { 0, RASTRO_ESPERA_NS };
+    while (!atomic_load(&rastro.parar)) {
+        if (esvaziarAneis() < RASTRO_ANEL / 2) nanosleep(&espera, NULL);
+    }
+    return NULL;
 }
 
 /* ------------------------------------------------------------
- * verificarSuspeitoFinal() – julgamento final:
- * - lista pistas coletadas
- * - pede acusação
- * - verifica se ≥ 2 pistas apontam para o acusado
+ * abrirRastro() – cria o arquivo e liga o rastro (chamar antes de
+ * criar as threads do jogo). Retorna 0 em caso de sucesso, -1 em
+ * caso de erro.
  * ------------------------------------------------------------ */
-void limparEntrada() {
-    int c; while ((c = getchar()) != '\n' && c != EOF) {}
+int abrirRastro(const char* caminho) {
+    memset(&rastro, 0, sizeof(rastro));
+    rastro.f = fopen(caminho, "wb");
+    if (!rastro.f) { fprintf(stderr, "Não foi possível criar o rastro '%s'.\n", caminho); return -1; }
+    setvbuf(rastro.f, NULL, _IOFBF, RASTRO_BUFFER);
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    CabecalhoRastro cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magica, RASTRO_MAGICA, 4);
+    cab.versao = RASTRO_VERSAO;
+    cab.tamRegistro = sizeof(RegistroRastro);
+    cab.epoca = (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+    rastro.ok = fwrite(&cab, sizeof(cab), 1, rastro.f) == 1;
+    rastro.inicio = rastro.passada = nsMonotonico();
+    if (pthread_create(&rastro.escritora, NULL, escreverRastro, NULL) != 0) {
+        fprintf(stderr, "Falha ao criar a thread do rastro.\n");
+        fclose(rastro.f);
+        return -1;
+    }
+    rastroGeracao++;
+    rastroLigado = 1;
+    return 0;
 }
 
-void verificarSuspeitoFinal(PistaNode* pistasBST, HashTable* ht) {
-    printf("\n==============================\n");
-    printf("Pistas coletadas (ordem A-Z):\n");
-    printf("==============================\n");
-    if (!pistasBST) {
-        printf("(nenhuma pista coletada)\n");
-    } else {
-        exibirPistas(pistasBST);
-    }
+/* ------------------------------------------------------------
+ * encerrarRastro() – para a escritora, grava o resto dos anéis,
+ * os textos do pool e o rodapé (chamar depois que as threads do
+ * jogo terminaram: os anéis são liberados aqui). Uma thread que
+ * continue viva e registre num rastro aberto depois ganha anel e
+ * lote novos (rastroGeracao). Retorna 0 em caso de sucesso, -1 em
+ * caso de erro.
+ * ------------------------------------------------------------ */
+int encerrarRastro(void) {
+    if (!rastroLigado) return 0;
+    rastroLigado = 0;
+    atomic_store(&rastro.parar, 1);
+    pthread_join(rastro.escritora, NULL);
+    esvaziarAneis();
 
-    printf("\nSuspeitos possíveis: Mordomo, Cozinheira, Jardineiro, Bibliotecária\n");
-    printf("Quem você acusa? ");
-    limparEntrada(); // limpa \n deixado por scanf anterior
-    char acusado[64];
-    if (!fgets(acusado, sizeof(acusado), stdin)) {
-        printf("Não foi possível ler a acusação.\n");
-        return;
+    RodapeRastro rod;
+    memset(&rod, 0, sizeof(rod));
+    memcpy(rod.magica, RASTRO_MAGICA_FIM, 4);
+    rod.offTextos = (uint64_t) ftello(rastro.f);
+    rod.numTextos = numTextos();
+    for (uint32_t id = 0; id < rod.numTextos && rastro.ok; ++id) {
+        const char* s = textoDoId(id);
+        size_t n = strlen(s) + 1;
+        if (fwrite(s, 1, n, rastro.f) != n) rastro.ok = 0;
+        rod.tamTextos += n;
     }
-    // remove \n
-    size_t len = strlen(acusado);
-    if (len && acusado[len-1] == '\n') acusado[len-1] = '\0';
-
-    int qnt = contarPistasParaSuspeito(pistasBST, ht, acusado);
-
-    printf("\nResultado do julgamento:\n");
-    if (qnt >= 2) {
-        printf("Acusação de \"%s\" SUSTENTADA por %d pistas. Caso encerrado!\n", acusado, qnt);
-    } else {
-        printf("Acusação de \"%s\" NÃO sustentada (apenas %d pista(s)). Investigue mais!\n", acusado, qnt);
+    static const char zeros[8];
+    size_t preenchimento = (size_t) ((8 - (rod.offTextos + rod.tamTextos) % 8) % 8);
+    if (rastro.ok && fwrite(zeros, 1, preenchimento, rastro.f) != preenchimento) rastro.ok = 0;
+    rod.numThreads = atomic_load(&rastro.numThreads);
+    AnelRastro* a = atomic_load(&rastro.aneis);
+    while (a) {
+        AnelRastro* prox = a->prox;
+        rod.perdidos += atomic_load(&a->perdidos);
+        free(a);
+        a = prox;
     }
+    if (rastro.ok && fwrite(&rod, sizeof(rod), 1, rastro.f) != 1) rastro.ok = 0;
+    if (fclose(rastro.f) != 0) rastro.ok = 0;
+    if (!rastro.ok) { fprintf(stderr, "Falha ao gravar o rastro.\n"); return -1; }
+    if (rod.perdidos) fprintf(stderr, "Rastro: %llu registro(s) perdido(s) com o anel cheio.\n",
+                              (unsigned long long) rod.perdidos);
+    return 0;
 }
 
 /* ============================================================
-   main() – monta o mapa fixo e roda o jogo
+   ESTRUTURA 1: Mansão (Árvore Binária)
+   Cada sala tem nome e o id da sua pista (ou SEM_PISTA).
    ============================================================ */
-int main(void) {
-    // 1) Monta a mansão (árvore binária fixa)
-    Sala* hall       = criarSala("Hall de Entrada");
-    Sala* salaEstar  = criarSala("Sala de Estar");
-    Sala* cozinha    = criarSala("Cozinha");
-    Sala* biblioteca = criarSala("Biblioteca");
-    Sala* jardim     = criarSala("Jardim");
-    Sala* quarto     = criarSala("Quarto");
-    Sala* adega      = criarSala("Adega");
+typedef struct Sala {
+    uint32_t nome;          // id do texto no pool
+    int pista;              // índice em TEXTO_PISTA
+    struct Sala *esquerda, *direita;
+} Sala;
+
+static inline const char* nomeSala(const Sala* s) {
+    return textoDoId(s->nome);
+}
+
+/* ------------------------------------------------------------
+ * criarSala() – cria um cômodo na arena do mapa e já resolve
+ * o id da pista dele
+ * ------------------------------------------------------------ */
+Sala* criarSala(Arena* a, const char* nome) {
+    Sala* s = (Sala*) arenaAlocar(a, sizeof(Sala));
+    s->nome = internarStr(nome);
+    s->pista = pistaIdPorSala(nome);
+    s->esquerda = s->direita = NULL;
+    return s;
+}
+
+/* ------------------------------------------------------------
+ * montarMansaoPadrao() – a mansão do jogo, sala a sala na arena
+ * (é daqui que gerar_padrao tira as tabelas estáticas)
+ * ------------------------------------------------------------ */
+Sala* montarMansaoPadrao(Arena* a) {
+    Sala* hall       = criarSala(a, "Hall de Entrada");
+    Sala* salaEstar  = criarSala(a, "Sala de Estar");
+    Sala* cozinha    = criarSala(a, "Cozinha");
+    Sala* biblioteca = criarSala(a, "Biblioteca");
+    Sala* jardim     = criarSala(a, "Jardim");
+    Sala* quarto     = criarSala(a, "Quarto");
+    Sala* adega      = criarSala(a, "Adega");
 
     // Ligações (pode ajustar a estrutura à vontade)
     hall->esquerda = salaEstar;
@@ -351,26 +901,4368 @@ int main(void) {
 
     cozinha->esquerda = quarto;
     cozinha->direita  = adega;
+    return hall;
+}
 
-    // 2) Cria BST de pistas (vazia no início)
-    PistaNode* pistasBST = NULL;
+#ifdef MANSAO_PADRAO_GERADA
+static Sala salasEmbutidas[PADRAO_NUM_SALAS] = PADRAO_SALAS;
+static const uint32_t idsPistasEmbutidas[NUM_PISTAS_PADRAO] = PADRAO_ID_PISTAS;
+#endif
 
-    // 3) Cria e carrega a tabela hash (pista -> suspeito)
-    HashTable* ht = criarHash(101);
-    carregarAssociacoes(ht);
+/* ------------------------------------------------------------
+ * mansaoPadrao() – Hall da mansão padrão: as salas estáticas
+ * pré-montadas (a arena nem é usada) ou, sem elas, montadas agora
+ * ------------------------------------------------------------ */
+Sala* mansaoPadrao(Arena* a) {
+#ifdef MANSAO_PADRAO_GERADA
+    (void) a;
+    return &salasEmbutidas[0];
+#else
+    return montarMansaoPadrao(a);
+#endif
+}
+
+/* idTextoPista() – id no pool do texto de uma pista do catálogo */
+static inline uint32_t idTextoPista(int pista) {
+#ifdef MANSAO_PADRAO_GERADA
+    return idsPistasEmbutidas[pista];
+#else
+    return internarStr(TEXTO_PISTA[pista]);
+#endif
+}
+
+/* ============================================================
+   ESTRUTURA 2: Pistas coletadas (BST balanceada – AVL)
+   Nós guardam o id do texto da pista (mais os 8 primeiros bytes,
+   que decidem a maioria das comparações sem ir ao pool) e a
+   altura da subárvore; as rotações mantêm a altura em O(log n)
+   mesmo quando as pistas chegam já em ordem alfabética.
+   ============================================================ */
+typedef struct PistaNode {
+    uint64_t prefixo;       // 8 primeiros bytes do texto (big-endian)
+    uint32_t pista;         // id do texto no pool
+    int altura;             // folha = 1
+    struct PistaNode *esq, *dir;
+} PistaNode;
 
-    // 4) Exploração interativa
-    printf("=== Detective Quest: Julgamento Final ===\n");
-    printf("Navegação: (e) esquerda, (d) direita, (s) sair\n");
-    explorarSalas(hall, &pistasBST);
+/* prefixoTexto() – 8 primeiros bytes como inteiro big-endian
+ * (completado com zeros): comparar prefixos = strcmp nesses bytes */
+static uint64_t prefixoTexto(const char* s) {
+    uint64_t p = 0;
+    for (int i = 0; i < 8 && s[i]; ++i) p |= (uint64_t) (unsigned char) s[i] << (56 - 8 * i);
+    return p;
+}
 
-    // 5) Julgamento
-    verificarSuspeitoFinal(pistasBST, ht);
+/* ------------------------------------------------------------
+ * criarPistaNode() – nó de pista para BST (na arena da sessão)
+ * ------------------------------------------------------------ */
+PistaNode* criarPistaNode(Arena* a, uint32_t pista) {
+    PistaNode* n = (PistaNode*) arenaAlocar(a, sizeof(PistaNode));
+    ESTAT(estatLocal.pistasCriadas++);
+    n->prefixo = prefixoTexto(textoDoId(pista));
+    n->pista = pista;
+    n->esq = n->dir = NULL;
+    n->altura = 1;
+    return n;
+}
 
-    // 6) Limpeza
-    liberarBST(pistasBST);
-    liberarHash(ht);
-    liberarMansao(hall);
+/* ------------------------------------------------------------
+ * Auxiliares AVL: altura, rotações e rebalanceamento de um nó
+ * ------------------------------------------------------------ */
+static int alturaPista(const PistaNode* n) {
+    return n ? n->altura : 0;
+}
 
-    return 0;
+static void atualizarAltura(PistaNode* n) {
+    int he = alturaPista(n->esq), hd = alturaPista(n->dir);
+    n->altura = 1 + (he > hd ? he : hd);
+}
+
+static PistaNode* rotacaoDireita(PistaNode* y) {
+    PistaNode* x = y->esq;
+    y->esq = x->dir;
+    x->dir = y;
+    atualizarAltura(y);
+    atualizarAltura(x);
+    return x;
+}
+
+static PistaNode* rotacaoEsquerda(PistaNode* x) {
+    PistaNode* y = x->dir;
+    x->dir = y->esq;
+    y->esq = x;
+    atualizarAltura(x);
+    atualizarAltura(y);
+    return y;
+}
+
+static PistaNode* rebalancear(PistaNode* n) {
+    atualizarAltura(n);
+    int fb = alturaPista(n->esq) - alturaPista(n->dir);
+    if (fb > 1) {
+        if (alturaPista(n->esq->esq) < alturaPista(n->esq->dir)) n->esq = rotacaoEsquerda(n->esq);
+        return rotacaoDireita(n);
+    }
+    if (fb < -1) {
+        if (alturaPista(n->dir->dir) < alturaPista(n->dir->esq)) n->dir = rotacaoDireita(n->dir);
+        return rotacaoEsquerda(n);
+    }
+    return n;
+}
+
+/* ============================================================
+   Pistas congeladas
+   Vetor de pistas já em ordem A-Z que não passa pela árvore nem
+   pelo pool: é como uma sessão retomada usa as pistas do snapshot
+   (ESTRUTURA 5), lidas direto do arquivo mapeado. Os cursores
+   intercalam o vetor com a árvore; pistas coletadas depois vão
+   só para a árvore, então os dois nunca repetem um texto.
+   Os campos de relação só interessam ao snapshot.
+   ============================================================ */
+typedef struct PistaCongelada {
+    uint64_t prefixo;               // prefixoTexto() do texto
+    uint32_t texto;                 // deslocamento em 'textos'
+    uint32_t suspeito;              // de maior peso, nos suspeitos do snapshot (ou SEM_INDICE)
+    uint32_t relacoes, numRelacoes; // faixa nas relações do snapshot
+} PistaCongelada;
+
+typedef struct PistasCongeladas {
+    const PistaCongelada* v;
+    uint32_t              n;
+    const char*           textos;   // strings terminadas em '\0'
+    size_t                tamTextos;
+} PistasCongeladas;
+
+/* textoCongelada() – texto da i-ésima pista ("" se o deslocamento
+ * sair da tabela: como no cenário, o arquivo é checado no uso) */
+static const char* textoCongelada(const PistasCongeladas* pc, uint32_t i) {
+    uint32_t off = pc->v[i].texto;
+    return off < pc->tamTextos ? pc->textos + off : "";
+}
+
+/* compararCongelada() – strcmp da i-ésima pista com 'texto' (o
+ * prefixo gravado decide a maioria sem tocar nas strings) */
+static int compararCongelada(const PistasCongeladas* pc, uint32_t i, uint64_t prefixo, const char* texto) {
+    if (pc->v[i].prefixo != prefixo) return pc->v[i].prefixo < prefixo ? -1 : 1;
+    return strcmp(textoCongelada(pc, i), texto);
+}
+
+/* limiteCongeladas() – primeira posição com texto >= 'texto'
+ * (> com 'depois'), por busca binária */
+static uint32_t limiteCongeladas(const PistasCongeladas* pc, const char* texto, int depois) {
+    uint64_t prefixo = prefixoTexto(texto);
+    uint32_t lo = 0, hi = pc->n;
+    while (lo < hi) {
+        uint32_t meio = lo + (hi - lo) / 2;
+        int c = compararCongelada(pc, meio, prefixo, texto);
+        if (c < 0 || (depois && c == 0)) lo = meio + 1;
+        else hi = meio;
+    }
+    return lo;
+}
+
+/* contemCongelada() – a pista já está no vetor? O(log n) */
+int contemCongelada(const PistasCongeladas* pc, const char* texto) {
+    if (!pc || !pc->n) return 0;
+    uint32_t i = limiteCongeladas(pc, texto, 0);
+    return i < pc->n && strcmp(textoCongelada(pc, i), texto) == 0;
+}
+
+/* ============================================================
+   Cursor em ordem sobre a árvore de pistas
+   Percorre a AVL com uma pilha explícita de tamanho fixo (a
+   altura de uma AVL com menos de 2^64 nós é < 93), sem
+   recursão. O cursor pode ser pausado e retomado a qualquer
+   momento, ou reposicionado pela última pista vista, o que
+   permite entregar as pistas em páginas. Com cursorIntercalar(),
+   cursorProxima() entrega também as pistas congeladas, na
+   mesma ordem.
+   ============================================================ */
+#define PISTA_ALTURA_MAX 96
+
+typedef struct CursorPistas {
+    const PistaNode* pilha[PISTA_ALTURA_MAX];
+    int topo;
+    const PistasCongeladas* congeladas;     // NULL = só a árvore
+    uint32_t proxCongelada;
+    uint32_t ultimaCongelada;               // de onde veio a última pista (SEM_INDICE = da árvore)
+} CursorPistas;
+
+static void zerarCursor(CursorPistas* c) {
+    c->topo = 0;
+    c->congeladas = NULL;
+    c->proxCongelada = 0;
+    c->ultimaCongelada = SEM_INDICE;
+}
+
+static void empilharEsquerda(CursorPistas* c, const PistaNode* n) {
+    while (n && c->topo < PISTA_ALTURA_MAX) {
+        c->pilha[c->topo++] = n;
+        n = n->esq;
+    }
+}
+
+/* cursorIniciar() – posiciona antes da primeira pista (ordem A-Z) */
+void cursorIniciar(CursorPistas* c, const PistaNode* raiz) {
+    zerarCursor(c);
+    empilharEsquerda(c, raiz);
 }
+
+/* ------------------------------------------------------------
+ * cursorIniciarDepois() – posiciona na primeira pista maior que
+ * 'ultima' (para retomar uma paginação só com a última chave)
+ * ------------------------------------------------------------ */
+void cursorIniciarDepois(CursorPistas* c, const PistaNode* raiz, const char* ultima) {
+    zerarCursor(c);
+    const PistaNode* n = raiz;
+    while (n && c->topo < PISTA_ALTURA_MAX) {
+        if (strcmp(textoDoId(n->pista), ultima) > 0) {
+            c->pilha[c->topo++] = n;   // n ainda será visitado
+            n = n->esq;
+        } else {
+            n = n->dir;
+        }
+    }
+}
+
+/* ------------------------------------------------------------
+ * cursorIniciarEm() – posiciona na primeira pista >= 'inicio'
+ * (com um prefixo, as pistas que o têm vêm todas em seguida)
+ * ------------------------------------------------------------ */
+void cursorIniciarEm(CursorPistas* c, const PistaNode* raiz, const char* inicio) {
+    zerarCursor(c);
+    const PistaNode* n = raiz;
+    while (n && c->topo < PISTA_ALTURA_MAX) {
+        if (strcmp(textoDoId(n->pista), inicio) >= 0) {
+            c->pilha[c->topo++] = n;
+            n = n->esq;
+        } else {
+            n = n->dir;
+        }
+    }
+}
+
+/* ------------------------------------------------------------
+ * cursorIntercalar() – junta ao cursor, já posicionado na árvore,
+ * as pistas de 'pc' a partir da primeira >= 'chave' (> com
+ * 'depois'; chave NULL = do começo)
+ * ------------------------------------------------------------ */
+void cursorIntercalar(CursorPistas* c, const PistasCongeladas* pc, const char* chave, int depois) {
+    if (!pc || !pc->n) return;
+    c->congeladas = pc;
+    c->proxCongelada = chave ? limiteCongeladas(pc, chave, depois) : 0;
+}
+
+/* cursorProximoNo() – próximo nó em ordem, ou NULL no fim (só a
+ * árvore: as pistas congeladas ficam de fora) */
+const PistaNode* cursorProximoNo(CursorPistas* c) {
+    if (c->topo == 0) return NULL;
+    const PistaNode* n = c->pilha[--c->topo];
+    empilharEsquerda(c, n->dir);
+    return n;
+}
+
+/* cursorProxima() – próxima pista em ordem (árvore e congeladas) */
+const char* cursorProxima(CursorPistas* c) {
+    const PistasCongeladas* pc = c->congeladas;
+    if (pc && c->proxCongelada < pc->n) {
+        const PistaNode* topo = c->topo ? c->pilha[c->topo - 1] : NULL;
+        if (!topo || compararCongelada(pc, c->proxCongelada, topo->prefixo, textoDoId(topo->pista)) < 0) {
+            c->ultimaCongelada = c->proxCongelada++;
+            return textoCongelada(pc, c->ultimaCongelada);
+        }
+    }
+    c->ultimaCongelada = SEM_INDICE;
+    const PistaNode* n = cursorProximoNo(c);
+    return n ? textoDoId(n->pista) : NULL;
+}
+
+/* ------------------------------------------------------------
+ * cursorPagina() – copia até 'max' pistas para 'saida' e
+ * devolve quantas copiou (0 = fim)
+ * ------------------------------------------------------------ */
+size_t cursorPagina(CursorPistas* c, const char** saida, size_t max) {
+    size_t n = 0;
+    const char* p;
+    while (n < max && (p = cursorProxima(c)) != NULL) saida[n++] = p;
+    return n;
+}
+
+/* ------------------------------------------------------------
+ * inserirPista() – insere a pista coletada na AVL (ordem alfabética)
+ * Evita duplicatas: se já existir, não insere novamente.
+ * A recursão desce no máximo ~1.44·log2(n) níveis.
+ * inserirPistaNova() faz o mesmo e marca *inserida = 1 quando a
+ * pista ainda não estava na árvore; inserirPistaId() recebe o
+ * texto já internado (duplicata = mesmo id, sem strcmp).
+ * ------------------------------------------------------------ */
+static PistaNode* inserirNo(Arena* a, PistaNode* raiz, uint32_t id, uint64_t prefixo,
+                            const char* texto, int* inserida) {
+    if (raiz == NULL) { *inserida = 1; return criarPistaNode(a, id); }
+    ESTAT(estatLocal.nosPercorridosPista++);
+    if (id == raiz->pista) return raiz; // igual: ignora duplicata
+
+    int menor = prefixo != raiz->prefixo ? prefixo < raiz->prefixo
+                                         : strcmp(texto, textoDoId(raiz->pista)) < 0;
+    if (menor) {
+        raiz->esq = inserirNo(a, raiz->esq, id, prefixo, texto, inserida);
+    } else {
+        raiz->dir = inserirNo(a, raiz->dir, id, prefixo, texto, inserida);
+    }
+    return rebalancear(raiz);
+}
+
+PistaNode* inserirPistaId(Arena* a, PistaNode* raiz, uint32_t id, const char* texto, int* inserida) {
+    return inserirNo(a, raiz, id, prefixoTexto(texto), texto, inserida);
+}
+
+PistaNode* inserirPistaNova(Arena* a, PistaNode* raiz, const char* pista, int* inserida) {
+    if (!pista || !*pista) return raiz;
+    uint32_t id = internarStr(pista);
+    return inserirPistaId(a, raiz, id, textoDoId(id), inserida);
+}
+
+PistaNode* inserirPista(Arena* a, PistaNode* raiz, const char* pista) {
+    int inserida = 0;
+    return inserirPistaNova(a, raiz, pista, &inserida);
+}
+
+/* ------------------------------------------------------------
+ * Carga em lote de pistas já ordenadas
+ * montarBalanceada() – liga nos[ini, fim) numa árvore perfeitamente
+ * balanceada (o meio vira raiz), em O(n). A recursão divide a faixa
+ * ao meio, então a profundidade é log2(n).
+ * ------------------------------------------------------------ */
+static PistaNode* montarBalanceada(PistaNode** nos, size_t ini, size_t fim) {
+    if (ini >= fim) return NULL;
+    size_t meio = ini + (fim - ini) / 2;
+    PistaNode* n = nos[meio];
+    n->esq = montarBalanceada(nos, ini, meio);
+    n->dir = montarBalanceada(nos, meio + 1, fim);
+    atualizarAltura(n);
+    return n;
+}
+
+static size_t contarPistas(const PistaNode* r) {
+    CursorPistas c;
+    size_t n = 0;
+    cursorIniciar(&c, r);
+    while (cursorProximoNo(&c)) n++;
+    return n;
+}
+
+/* ------------------------------------------------------------
+ * inserirPistasOrdenadas() – acrescenta um lote em ordem
+ * alfabética (ex.: despejo de evidências) em O(n + m): intercala
+ * o lote com os nós já existentes, descarta duplicatas e
+ * reconstrói a árvore balanceada reaproveitando os nós antigos.
+ * Se o lote não estiver ordenado, cai na inserção um a um.
+ * ------------------------------------------------------------ */
+PistaNode* inserirPistasOrdenadas(Arena* a, PistaNode* raiz, const char* const* lote, size_t m) {
+    for (size_t i = 1; i < m; ++i) {
+        if (strcmp(lote[i-1], lote[i]) > 0) {
+            for (size_t j = 0; j < m; ++j) raiz = inserirPista(a, raiz, lote[j]);
+            return raiz;
+        }
+    }
+
+    size_t n = contarPistas(raiz);
+    PistaNode** antigos = (PistaNode**) malloc((n ? n : 1) * sizeof(PistaNode*));
+    PistaNode** nos = (PistaNode**) malloc((n + m ? n + m : 1) * sizeof(PistaNode*));
+    if (!antigos || !nos) { fprintf(stderr, "Falha ao alocar carga em lote.\n"); exit(1); }
+    CursorPistas cur;
+    cursorIniciar(&cur, raiz);
+    for (size_t k = 0; k < n; ++k) antigos[k] = (PistaNode*) cursorProximoNo(&cur);
+
+    size_t i = 0, j = 0, total = 0;
+    while (i < n || j < m) {
+        if (j < m && !*lote[j]) { j++; continue; }
+        int cmp = (i == n) ? 1 : (j == m) ? -1 : strcmp(textoDoId(antigos[i]->pista), lote[j]);
+        if (cmp <= 0) {
+            nos[total++] = antigos[i++];
+            if (cmp == 0) j++;
+        } else if (total && strcmp(textoDoId(nos[total-1]->pista), lote[j]) == 0) {
+            j++;    // duplicata dentro do próprio lote
+        } else {
+            nos[total++] = criarPistaNode(a, internarStr(lote[j++]));
+        }
+    }
+
+    raiz = montarBalanceada(nos, 0, total);
+    free(antigos);
+    free(nos);
+    return raiz;
+}
+
+/* ------------------------------------------------------------
+ * escreverPista() – uma linha da listagem: "- pista" ou, no modo
+ * compacto, só a pista (sem formatação, direto no buffer)
+ * ------------------------------------------------------------ */
+static void escreverPista(Saida* so, const char* p) {
+    if (!so->compacto) escreverTexto(so, "- ", 2);
+    escreverStr(so, p);
+    escreverTexto(so, "\n", 1);
+}
+
+/* ------------------------------------------------------------
+ * exibirPistas() – imprime a BST em ordem alfabética
+ * ------------------------------------------------------------ */
+void exibirPistas(const PistaNode* r) {
+    Saida* so = saidaPadrao();
+    CursorPistas c;
+    const char* p;
+    cursorIniciar(&c, r);
+    while ((p = cursorProxima(&c)) != NULL) escreverPista(so, p);
+    descarregar(so);
+}
+
+/* ------------------------------------------------------------
+ * exibirPistasPagina() – imprime até 'max' pistas depois de
+ * 'depoisDe' (NULL = do começo); devolve quantas imprimiu
+ * ------------------------------------------------------------ */
+size_t exibirPistasPagina(const PistaNode* r, const char* depoisDe, size_t max) {
+    Saida* so = saidaPadrao();
+    CursorPistas c;
+    const char* p;
+    size_t n = 0;
+    if (depoisDe) cursorIniciarDepois(&c, r, depoisDe);
+    else          cursorIniciar(&c, r);
+    while (n < max && (p = cursorProxima(&c)) != NULL) { escreverPista(so, p); n++; }
+    descarregar(so);
+    return n;
+}
+
+/* ============================================================
+   Busca nas pistas coletadas
+   - por início: a AVL já está em ordem, então basta posicionar o
+     cursor na primeira pista >= prefixo e andar enquanto o prefixo
+     bater – O(log n + resultados), sem estrutura extra.
+   - por trecho: índice de trigramas (3 bytes seguidos), montado
+     na primeira busca da sessão (sessões que nunca buscam não
+     pagam nada) e daí em diante acompanhando cada pista nova.
+     Cada trigrama aponta para a lista
+     das pistas que o contêm; a consulta percorre só a lista mais
+     curta entre os trigramas do trecho e confirma com strstr().
+     Trechos com menos de 3 bytes varrem a árvore.
+   A comparação é byte a byte (diferencia maiúsculas), como a
+   ordem da árvore.
+   ============================================================ */
+#define OCORRENCIAS_BLOCO 13    // blocos de 64 bytes
+
+typedef struct BlocoOcorrencias {
+    struct BlocoOcorrencias* prox;
+    uint32_t n;
+    uint32_t textos[OCORRENCIAS_BLOCO];    // ids no pool
+} BlocoOcorrencias;
+
+typedef struct ListaTrigrama {
+    uint32_t chave;             // 3 bytes do trigrama (0 = posição vazia)
+    uint32_t total;
+    BlocoOcorrencias* primeiro;
+    BlocoOcorrencias* ultimo;
+} ListaTrigrama;
+
+typedef struct IndiceTrigramas {
+    ListaTrigrama* listas;      // endereçamento aberto, na arena da sessão
+    uint32_t capacidade, usadas;
+} IndiceTrigramas;
+
+static inline uint32_t chaveTrigrama(const char* p) {
+    return (uint32_t) (unsigned char) p[0] << 16 | (uint32_t) (unsigned char) p[1] << 8
+         | (unsigned char) p[2];
+}
+
+static ListaTrigrama* listaTrigrama(const IndiceTrigramas* ix, uint32_t chave) {
+    if (!ix->capacidade) return NULL;
+    uint32_t mascara = ix->capacidade - 1;
+    uint32_t i = (uint32_t) ((chave * 0x9E3779B97F4A7C15ull) >> 40) & mascara;
+    while (ix->listas[i].chave && ix->listas[i].chave != chave) i = (i + 1) & mascara;
+    return &ix->listas[i];
+}
+
+/* ------------------------------------------------------------
+ * indexarPista() – acrescenta a pista (id no pool) às listas de
+ * todos os seus trigramas; chamada uma vez por pista
+ * ------------------------------------------------------------ */
+void indexarPista(Arena* a, IndiceTrigramas* ix, uint32_t texto) {
+    const char* p = textoDoId(texto);
+    size_t tam = entradaTexto(texto)->tam;
+    for (size_t k = 0; k + 3 <= tam; ++k) {
+        // carga máxima de 1/2: a tabela velha fica na arena até o reset
+        if ((ix->usadas + 1) * 2 > ix->capacidade) {
+            IndiceTrigramas novo = { NULL, ix->capacidade ? ix->capacidade * 2 : 64, 0 };
+            novo.listas = (ListaTrigrama*) arenaAlocar(a, novo.capacidade * sizeof(ListaTrigrama));
+            memset(novo.listas, 0, novo.capacidade * sizeof(ListaTrigrama));
+            for (uint32_t i = 0; i < ix->capacidade; ++i)
+                if (ix->listas[i].chave) *listaTrigrama(&novo, ix->listas[i].chave) = ix->listas[i];
+            novo.usadas = ix->usadas;
+            *ix = novo;
+        }
+        uint32_t chave = chaveTrigrama(p + k);
+        ListaTrigrama* l = listaTrigrama(ix, chave);
+        if (!l->chave) { l->chave = chave; ix->usadas++; }
+        BlocoOcorrencias* b = l->ultimo;
+        if (b && b->textos[b->n - 1] == texto) continue;   // trigrama repetido na mesma pista
+        if (!b || b->n == OCORRENCIAS_BLOCO) {
+            BlocoOcorrencias* novo = (BlocoOcorrencias*) arenaAlocar(a, sizeof(BlocoOcorrencias));
+            novo->prox = NULL;
+            novo->n = 0;
+            if (b) b->prox = novo;
+            else   l->primeiro = novo;
+            l->ultimo = b = novo;
+        }
+        b->textos[b->n++] = texto;
+        l->total++;
+    }
+}
+
+/* ------------------------------------------------------------
+ * buscarPrefixo() – copia até 'max' pistas (da árvore e de 'pc',
+ * que pode ser NULL) que começam com 'prefixo' (ordem A-Z);
+ * devolve quantas copiou
+ * ------------------------------------------------------------ */
+size_t buscarPrefixo(const PistaNode* raiz, const PistasCongeladas* pc, const char* prefixo,
+                     const char** saida, size_t max) {
+    size_t tam = strlen(prefixo), n = 0;
+    CursorPistas c;
+    const char* p;
+    cursorIniciarEm(&c, raiz, prefixo);
+    cursorIntercalar(&c, pc, prefixo, 0);
+    while (n < max && (p = cursorProxima(&c)) != NULL && strncmp(p, prefixo, tam) == 0) saida[n++] = p;
+    return n;
+}
+
+/* ------------------------------------------------------------
+ * buscarTrecho() – copia até 'max' pistas que contêm 'trecho'
+ * (na ordem em que entraram no índice); devolve quantas copiou.
+ * O índice deve cobrir a árvore e 'pc' (ver buscarNaSessao()).
+ * ------------------------------------------------------------ */
+size_t buscarTrecho(const IndiceTrigramas* ix, const PistaNode* raiz, const PistasCongeladas* pc,
+                    const char* trecho, const char** saida, size_t max) {
+    size_t tam = strlen(trecho), n = 0;
+    if (tam < 3) {
+        CursorPistas c;
+        const char* p;
+        cursorIniciar(&c, raiz);
+        cursorIntercalar(&c, pc, NULL, 0);
+        while (n < max && (p = cursorProxima(&c)) != NULL)
+            if (strstr(p, trecho)) saida[n++] = p;
+        return n;
+    }
+    const ListaTrigrama* menor = NULL;
+    for (size_t k = 0; k + 3 <= tam; ++k) {
+        const ListaTrigrama* l = listaTrigrama(ix, chaveTrigrama(trecho + k));
+        if (!l || !l->chave) return 0;     // trigrama que nenhuma pista tem
+        if (!menor || l->total < menor->total) menor = l;
+    }
+    for (const BlocoOcorrencias* b = menor->primeiro; b && n < max; b = b->prox)
+        for (uint32_t i = 0; i < b->n && n < max; ++i) {
+            const char* p = textoDoId(b->textos[i]);
+            if (tam == 3 || strstr(p, trecho)) saida[n++] = p;
+        }
+    return n;
+}
+
+/* ============================================================
+   Sessão de jogo: dona da arena onde ficam as pistas coletadas.
+   Encerrar a sessão é um único reset da arena (mais o munmap do
+   snapshot, numa sessão retomada).
+   ============================================================ */
+typedef struct Sessao {
+    Arena      arena;
+    PistaNode* pistas;
+    size_t     numPistas;
+    uint32_t   salasVisitadas;
+    // Contadores por suspeito (índice = id do suspeito na hash),
+    // atualizados só quando uma pista nova entra na árvore
+    uint32_t*  votos;           // soma dos pesos das pistas contra cada suspeito
+    uint32_t*  ordem;           // ids em ordem decrescente de votos
+    uint32_t*  posicao;         // id -> posição em 'ordem'
+    uint32_t   numSuspeitos, capSuspeitos;
+    IndiceTrigramas trigramas;  // busca por trecho nas pistas coletadas
+    int        trigramasProntos;    // índice montado (ver buscarNaSessao())
+    // Sessão retomada: as pistas do snapshot ficam no arquivo
+    // mapeado (numPistas já as conta) e só as novas vão à árvore
+    PistasCongeladas congeladas;
+    void*      mapaRetomado;
+    size_t     tamRetomado;
+    uint32_t*  suspeitosRetomados;  // índice no snapshot -> id na hash
+    uint32_t   idRastro;        // número da sessão no rastro (0 = ainda sem, ver sessaoRastro())
+} Sessao;
+
+static void zerarEstadoSessao(Sessao* s) {
+    s->pistas = NULL;
+    s->numPistas = 0;
+    s->salasVisitadas = 0;
+    s->votos = s->ordem = s->posicao = NULL;
+    s->numSuspeitos = s->capSuspeitos = 0;
+    s->trigramas.listas = NULL;
+    s->trigramas.capacidade = s->trigramas.usadas = 0;
+    s->trigramasProntos = 0;
+    memset(&s->congeladas, 0, sizeof(s->congeladas));
+    s->mapaRetomado = NULL;
+    s->tamRetomado = 0;
+    s->suspeitosRetomados = NULL;
+    s->idRastro = 0;
+}
+
+/* soltarRetomada() – desfaz o mapeamento do snapshot retomado */
+static void soltarRetomada(Sessao* s) {
+    if (s->mapaRetomado) munmap(s->mapaRetomado, s->tamRetomado);
+}
+
+/* sessaoRastro() – número da sessão no rastro, reservado no
+ * primeiro evento (usar só dentro de RASTRO()) */
+static inline uint32_t sessaoRastro(Sessao* s) {
+    if (!s->idRastro) s->idRastro = novaSessaoRastro();
+    return s->idRastro;
+}
+
+/* fecharSessaoRastro() – resumo da sessão que termina; uma sessão
+ * em que nada aconteceu não deixa registro */
+static void fecharSessaoRastro(Sessao* s) {
+    if (s->idRastro || s->salasVisitadas || s->numPistas)
+        RASTRO(RASTRO_FIM_SESSAO, sessaoRastro(s), s->salasVisitadas, (uint32_t) s->numPistas);
+}
+
+void iniciarSessao(Sessao* s) {
+    arenaIniciar(&s->arena);
+    zerarEstadoSessao(s);
+}
+
+#ifdef DQ_ESTATISTICAS
+/* registra salas e pistas de uma sessão que está sendo encerrada */
+static void contarFimSessao(const Sessao* s) {
+    if (!s->salasVisitadas && !s->numPistas) return;
+    estatLocal.sessoes++;
+    estatLocal.salasVisitadas += s->salasVisitadas;
+    estatLocal.pistasColetadas += s->numPistas;
+    ESTAT_MAX(maxSalasSessao, s->salasVisitadas);
+    ESTAT_MAX(maxPistasSessao, s->numPistas);
+}
+#endif
+
+/* reiniciarSessao() – zera o estado e guarda a memória para reuso */
+void reiniciarSessao(Sessao* s) {
+    ESTAT(contarFimSessao(s));
+    fecharSessaoRastro(s);
+    soltarRetomada(s);
+    arenaResetar(&s->arena);
+    zerarEstadoSessao(s);
+}
+
+void liberarSessao(Sessao* s) {
+    ESTAT(contarFimSessao(s));
+    fecharSessaoRastro(s);
+    soltarRetomada(s);
+    arenaLiberar(&s->arena);
+    zerarEstadoSessao(s);
+}
+
+/* cursorSessao() – cursor sobre todas as pistas da sessão */
+void cursorSessao(CursorPistas* c, const Sessao* s) {
+    cursorIniciar(c, s->pistas);
+    cursorIntercalar(c, &s->congeladas, NULL, 0);
+}
+
+/* ------------------------------------------------------------
+ * buscarNaSessao() – "^início" busca por prefixo, o resto por
+ * trecho. O índice de trigramas é montado na primeira busca por
+ * trecho (as pistas congeladas só então entram no pool) e daí em
+ * diante coletarPistaId() o mantém.
+ * ------------------------------------------------------------ */
+size_t buscarNaSessao(Sessao* s, const char* consulta, const char** saida, size_t max) {
+    if (consulta[0] == '^') return buscarPrefixo(s->pistas, &s->congeladas, consulta + 1, saida, max);
+    if (!s->trigramasProntos && strlen(consulta) >= 3) {
+        CursorPistas c;
+        const char* p;
+        cursorSessao(&c, s);
+        while ((p = cursorProxima(&c)) != NULL) indexarPista(&s->arena, &s->trigramas, internarStr(p));
+        s->trigramasProntos = 1;
+    }
+    return buscarTrecho(&s->trigramas, s->pistas, &s->congeladas, consulta, saida, max);
+}
+
+/* ------------------------------------------------------------
+ * relatorioMemoria() – uso de memória de uma arena
+ * ------------------------------------------------------------ */
+void relatorioMemoria(FILE* out, const char* rotulo, const Arena* a) {
+    fprintf(out, "%s: %zu alocações, %zu bytes usados, %zu bytes reservados\n",
+            rotulo, a->numAlocacoes, a->bytesUsados, a->bytesReservados);
+}
+
+/* ============================================================
+   ESTRUTURA 3: Relações pista <-> suspeito (com peso)
+   Uma pista pode apontar para vários suspeitos, cada um com um
+   peso de 1 a PESO_MAX. Pistas com alguma relação ganham um
+   índice denso (0, 1, 2, ...), achado pelo id do texto no pool
+   com um acesso direto ao vetor pistaDoTexto.
+   A pontuação de uma sessão não relê as relações: cada pista
+   coletada soma os seus pesos nos contadores de votos da sessão
+   (ver contarVoto()), então o veredito é uma leitura, O(1).
+   ============================================================ */
+#define PESO_MAX  255u
+#define PESO_SUSTENTA 2u        // soma de pesos que sustenta uma acusação (ver votosPara())
+
+typedef struct Relacao {
+    uint32_t suspeito, peso;        // peso 0 = relação removida
+    struct Relacao* prox;
+} Relacao;
+
+typedef struct HashTable {
+    uint32_t* pistaDoTexto;     // id do texto -> índice da pista (SEM_INDICE = nenhuma)
+    size_t capacidade;          // posições em pistaDoTexto
+    // Pistas com relação, por índice denso
+    uint32_t* principal;        // suspeito de maior peso (SEM_INDICE = nenhum)
+    Relacao** relacoes;         // lista de (suspeito, peso), na ordem de inserção
+    uint32_t numPistas, capPistas;
+    size_t ocupados;            // relações com peso > 0
+    Arena nos;                  // nós de Relacao
+    // Suspeitos: cada nome distinto (sem diferenciar maiúsculas)
+    // ganha um id sequencial
+    const char** nomesSuspeitos;
+    uint32_t numSuspeitos, capSuspeitos;
+    uint32_t* indiceSuspeitos;  // endereçamento aberto: id + 1 (0 = vazio)
+    size_t capIndice;
+    int embutida;               // 1 = vetores estáticos (pré-montada), 2 = só a struct
+} HashTable;
+
+/* ------------------------------------------------------------
+ * criarHash() – cria a tabela com espaço inicial para ids de
+ * texto até ~capacidade (cresce sozinha)
+ * ------------------------------------------------------------ */
+HashTable* criarHash(size_t capacidade) {
+    HashTable* ht = (HashTable*) calloc(1, sizeof(HashTable));
+    if (!ht) { fprintf(stderr, "Falha ao alocar HashTable.\n"); exit(1); }
+    ht->capacidade = capacidade > 16 ? capacidade : 16;
+    ht->pistaDoTexto = (uint32_t*) malloc(ht->capacidade * sizeof(uint32_t));
+    ht->capPistas = 64;
+    ht->principal = (uint32_t*) malloc(ht->capPistas * sizeof(uint32_t));
+    ht->relacoes = (Relacao**) malloc(ht->capPistas * sizeof(Relacao*));
+    if (!ht->pistaDoTexto || !ht->principal || !ht->relacoes) {
+        fprintf(stderr, "Falha ao alocar associações.\n");
+        exit(1);
+    }
+    memset(ht->pistaDoTexto, 0xFF, ht->capacidade * sizeof(uint32_t));
+    arenaIniciar(&ht->nos);
+    return ht;
+}
+
+/* ------------------------------------------------------------
+ * util: comparação sem diferenciar maiúsculas (UTF-8)
+ * Dobra para minúsculas o ASCII, o Latin-1 (À..Þ -> à..þ) e o
+ * Latin Extended-A (Ā..ž), então "BIBLIOTECÁRIA" == "Bibliotecária".
+ * Trechos só-ASCII são comparados 16 (SSE2) ou 32 (AVX2) bytes
+ * por vez; o resto passa pelo caminho escalar, code point a code
+ * point.
+ * ------------------------------------------------------------ */
+
+/* dobrarCodepoint() – minúscula de um code point (faixas acima) */
+static uint32_t dobrarCodepoint(uint32_t c) {
+    if (c >= 'A' && c <= 'Z') return c + 32;
+    if (c < 0xC0) return c;
+    if (c <= 0xDE) return c == 0xD7 ? c : c + 32;           // × não tem caixa
+    if (c < 0x100 || c > 0x17F) return c;
+    if (c == 0x130) return 'i';                              // İ
+    if (c == 0x178) return 0xFF;                             // Ÿ -> ÿ
+    if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E))
+        return (c & 1) ? c + 1 : c;                          // maiúsculas ímpares
+    if (c == 0x138 || c == 0x149 || c == 0x17F) return c;    // sem par
+    return (c & 1) ? c : c + 1;                              // maiúsculas pares
+}
+
+/* ------------------------------------------------------------
+ * proximoDobrado() – decodifica um code point de *p, avança o
+ * ponteiro e devolve a forma minúscula. Bytes inválidos viram
+ * valores fora do Unicode (0x110000 + byte), iguais só a si mesmos.
+ * ------------------------------------------------------------ */
+static uint32_t proximoDobrado(const char** p) {
+    const unsigned char* s = (const unsigned char*) *p;
+    uint32_t c = s[0];
+    int n = 1;
+    if (c < 0x80) {
+        *p += 1;
+        return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+    }
+    if      ((c & 0xE0) == 0xC0 && (s[1] & 0xC0) == 0x80) { c = ((c & 0x1F) << 6) | (s[1] & 0x3F); n = 2; }
+    else if ((c & 0xF0) == 0xE0 && (s[1] & 0xC0) == 0x80 && (s[2] & 0xC0) == 0x80) {
+        c = ((c & 0x0F) << 12) | ((uint32_t) (s[1] & 0x3F) << 6) | (s[2] & 0x3F); n = 3;
+    } else if ((c & 0xF8) == 0xF0 && (s[1] & 0xC0) == 0x80 && (s[2] & 0xC0) == 0x80 && (s[3] & 0xC0) == 0x80) {
+        c = ((c & 0x07) << 18) | ((uint32_t) (s[1] & 0x3F) << 12) | ((uint32_t) (s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+        n = 4;
+    } else {
+        *p += 1;
+        return 0x110000u + c;
+    }
+    *p += n;
+    return dobrarCodepoint(c);
+}
+
+/* ------------------------------------------------------------
+ * dobrarUtf8() – grava em buf a forma minúscula de s (UTF-8),
+ * truncando em cap bytes; devolve o tamanho gravado
+ * ------------------------------------------------------------ */
+size_t dobrarUtf8(const char* s, char* buf, size_t cap) {
+    size_t n = 0;
+    while (*s) {
+        uint32_t c = proximoDobrado(&s);
+        unsigned char tmp[4];
+        size_t k;
+        if (c < 0x80)         { tmp[0] = (unsigned char) c; k = 1; }
+        else if (c < 0x800)   { tmp[0] = 0xC0 | (c >> 6); tmp[1] = 0x80 | (c & 0x3F); k = 2; }
+        else if (c < 0x10000) { tmp[0] = 0xE0 | (c >> 12); tmp[1] = 0x80 | ((c >> 6) & 0x3F);
+                                tmp[2] = 0x80 | (c & 0x3F); k = 3; }
+        else if (c < 0x110000){ tmp[0] = 0xF0 | (c >> 18); tmp[1] = 0x80 | ((c >> 12) & 0x3F);
+                                tmp[2] = 0x80 | ((c >> 6) & 0x3F); tmp[3] = 0x80 | (c & 0x3F); k = 4; }
+        else                  { tmp[0] = (unsigned char) (c - 0x110000u); k = 1; }  // byte inválido
+        if (n + k > cap) break;
+        memcpy(buf + n, tmp, k);
+        n += k;
+    }
+    return n;
+}
+
+/* colunasUtf8() – caracteres (code points) de s, para alinhar
+ * tabelas: printf("%-20s") conta bytes */
+int colunasUtf8(const char* s) {
+    int n = 0;
+    for (const unsigned char* p = (const unsigned char*) s; *p; ++p) n += (*p & 0xC0) != 0x80;
+    return n;
+}
+
+/* podeLer() – dá para ler 'n' bytes a partir de p sem sair da
+ * página (a string pode terminar antes, mas a leitura não falha) */
+#define PAGINA_MIN 4096u
+#define podeLer(p, n) ((((uintptr_t) (p)) & (PAGINA_MIN - 1)) <= PAGINA_MIN - (n))
+
+// A leitura em bloco pode passar do '\0' (sem sair da página), o
+// que o AddressSanitizer acusaria: nesses builds fica só o escalar.
+#if defined(__SANITIZE_ADDRESS__)
+#elif defined(__AVX2__)
+#define IEQ_LARGURA 32
+/* bloco ASCII, sem '\0' e igual após dobrar? */
+static inline int blocoIgualAscii(const char* a, const char* b) {
+    __m256i va = _mm256_loadu_si256((const __m256i*) a);
+    __m256i vb = _mm256_loadu_si256((const __m256i*) b);
+    const __m256i antesA = _mm256_set1_epi8('A' - 1), depoisZ = _mm256_set1_epi8('Z' + 1);
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    __m256i ma = _mm256_and_si256(_mm256_cmpgt_epi8(va, antesA), _mm256_cmpgt_epi8(depoisZ, va));
+    __m256i mb = _mm256_and_si256(_mm256_cmpgt_epi8(vb, antesA), _mm256_cmpgt_epi8(depoisZ, vb));
+    va = _mm256_or_si256(va, _mm256_and_si256(ma, bit));
+    vb = _mm256_or_si256(vb, _mm256_and_si256(mb, bit));
+    __m256i zero = _mm256_cmpeq_epi8(va, _mm256_setzero_si256());
+    uint32_t iguais = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+    uint32_t ruins  = (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(zero, _mm256_or_si256(va, vb)));
+    return iguais == 0xFFFFFFFFu && ruins == 0;  // 'ruins': '\0' ou byte >= 0x80
+}
+#elif defined(__SSE2__)
+#define IEQ_LARGURA 16
+static inline int blocoIgualAscii(const char* a, const char* b) {
+    __m128i va = _mm_loadu_si128((const __m128i*) a);
+    __m128i vb = _mm_loadu_si128((const __m128i*) b);
+    const __m128i antesA = _mm_set1_epi8('A' - 1), depoisZ = _mm_set1_epi8('Z' + 1);
+    const __m128i bit = _mm_set1_epi8(0x20);
+    __m128i ma = _mm_and_si128(_mm_cmpgt_epi8(va, antesA), _mm_cmplt_epi8(va, depoisZ));
+    __m128i mb = _mm_and_si128(_mm_cmpgt_epi8(vb, antesA), _mm_cmplt_epi8(vb, depoisZ));
+    va = _mm_or_si128(va, _mm_and_si128(ma, bit));
+    vb = _mm_or_si128(vb, _mm_and_si128(mb, bit));
+    __m128i zero = _mm_cmpeq_epi8(va, _mm_setzero_si128());
+    int iguais = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+    int ruins  = _mm_movemask_epi8(_mm_or_si128(zero, _mm_or_si128(va, vb)));
+    return iguais == 0xFFFF && ruins == 0;       // 'ruins': '\0' ou byte >= 0x80
+}
+#endif
+
+int str_ieq(const char* a, const char* b) {
+    if (!a || !b) return 0;
+    for (;;) {
+#ifdef IEQ_LARGURA
+        while (podeLer(a, IEQ_LARGURA) && podeLer(b, IEQ_LARGURA) && blocoIgualAscii(a, b)) {
+            a += IEQ_LARGURA;
+            b += IEQ_LARGURA;
+        }
+        // bloco com diferença, '\0' ou UTF-8: segue escalar até passar dele
+        const char* fimEscalar = a + IEQ_LARGURA;
+#else
+        const char* fimEscalar = NULL;
+#endif
+        do {
+            uint32_t ca = proximoDobrado(&a), cb = proximoDobrado(&b);
+            if (ca != cb) return 0;
+            if (ca == 0) return 1;
+        } while (!fimEscalar || a < fimEscalar);
+    }
+}
+
+/* ------------------------------------------------------------
+ * hashSuspeito() – hash do nome dobrado para minúsculas (mesma
+ * regra de str_ieq), para achar o id de "mordomo" ou "MORDOMO"
+ * ------------------------------------------------------------ */
+static uint32_t hashSuspeito(const char* nome) {
+    char buf[256];
+    return hash_rapido(buf, dobrarUtf8(nome, buf, sizeof(buf)));
+}
+
+static uint32_t* posicaoSuspeito(const HashTable* ht, const char* nome) {
+    size_t mascara = ht->capIndice - 1;
+    size_t i = hashSuspeito(nome) & mascara;
+    while (ht->indiceSuspeitos[i] && !str_ieq(ht->nomesSuspeitos[ht->indiceSuspeitos[i] - 1], nome))
+        i = (i + 1) & mascara;
+    return &ht->indiceSuspeitos[i];
+}
+
+/* ------------------------------------------------------------
+ * idSuspeito() – id do suspeito pelo nome (ou SEM_INDICE)
+ * ------------------------------------------------------------ */
+uint32_t idSuspeito(const HashTable* ht, const char* nome) {
+    if (!ht || !nome || !ht->capIndice) return SEM_INDICE;
+    uint32_t v = *posicaoSuspeito(ht, nome);
+    return v ? v - 1 : SEM_INDICE;
+}
+
+const char* nomeSuspeito(const HashTable* ht, uint32_t id) {
+    return id < ht->numSuspeitos ? ht->nomesSuspeitos[id] : "";
+}
+
+/* ------------------------------------------------------------
+ * registrarSuspeito() – devolve o id do suspeito, criando-o se
+ * for um nome novo
+ * ------------------------------------------------------------ */
+static uint32_t registrarSuspeito(HashTable* ht, const char* nome) {
+    uint32_t id = idSuspeito(ht, nome);
+    if (id != SEM_INDICE) return id;
+
+    if (ht->numSuspeitos == ht->capSuspeitos) {
+        uint32_t cap = ht->capSuspeitos ? ht->capSuspeitos * 2 : 8;
+        const char** nomes = (const char**) realloc(ht->nomesSuspeitos, cap * sizeof(char*));
+        uint32_t* indice = (uint32_t*) calloc(cap * 2, sizeof(uint32_t));
+        if (!nomes || !indice) { fprintf(stderr, "Falha ao alocar suspeitos.\n"); exit(1); }
+        ht->nomesSuspeitos = nomes;
+        ht->capSuspeitos = cap;
+        free(ht->indiceSuspeitos);
+        ht->indiceSuspeitos = indice;
+        ht->capIndice = cap * 2;
+        for (uint32_t i = 0; i < ht->numSuspeitos; ++i)
+            *posicaoSuspeito(ht, ht->nomesSuspeitos[i]) = i + 1;
+    }
+    id = ht->numSuspeitos++;
+    ht->nomesSuspeitos[id] = textoDoId(internarStr(nome));
+    *posicaoSuspeito(ht, nome) = id + 1;
+    return id;
+}
+
+/* indicePista() – índice denso da pista com esse id de texto */
+static inline uint32_t indicePista(const HashTable* ht, uint32_t texto) {
+    return texto < ht->capacidade ? ht->pistaDoTexto[texto] : SEM_INDICE;
+}
+
+/* suspeitoDoTexto() – suspeito de maior peso para um id de texto */
+static inline uint32_t suspeitoDoTexto(const HashTable* ht, uint32_t texto) {
+    uint32_t p = indicePista(ht, texto);
+    return p != SEM_INDICE ? ht->principal[p] : SEM_INDICE;
+}
+
+/* crescerPistas() – dobra os vetores por pista */
+static void crescerPistas(HashTable* ht) {
+    uint32_t cap = ht->capPistas * 2;
+    uint32_t* principal = (uint32_t*) realloc(ht->principal, cap * sizeof(uint32_t));
+    Relacao** relacoes = (Relacao**) realloc(ht->relacoes, cap * sizeof(Relacao*));
+    if (!principal || !relacoes) { fprintf(stderr, "Falha ao alocar associações.\n"); exit(1); }
+    ht->principal = principal;
+    ht->relacoes = relacoes;
+    ht->capPistas = cap;
+}
+
+/* novaPista() – índice denso da pista, criando-o se preciso */
+static uint32_t novaPista(HashTable* ht, uint32_t texto) {
+    if (texto >= ht->capacidade) {
+        size_t cap = ht->capacidade * 2;
+        while (cap <= texto) cap *= 2;
+        uint32_t* novo = (uint32_t*) realloc(ht->pistaDoTexto, cap * sizeof(uint32_t));
+        if (!novo) { fprintf(stderr, "Falha ao alocar associações.\n"); exit(1); }
+        memset(novo + ht->capacidade, 0xFF, (cap - ht->capacidade) * sizeof(uint32_t));
+        ht->pistaDoTexto = novo;
+        ht->capacidade = cap;
+    }
+    if (ht->pistaDoTexto[texto] != SEM_INDICE) return ht->pistaDoTexto[texto];
+    if (ht->numPistas == ht->capPistas) crescerPistas(ht);
+    uint32_t p = ht->numPistas++;
+    ht->principal[p] = SEM_INDICE;
+    ht->relacoes[p] = NULL;
+    ht->pistaDoTexto[texto] = p;
+    return p;
+}
+
+/* ------------------------------------------------------------
+ * materializarHash() – copia para o heap uma tabela pré-montada
+ * (vetores estáticos) antes da primeira mudança nela
+ * ------------------------------------------------------------ */
+static void materializarHash(HashTable* ht) {
+    uint32_t* pistaDoTexto = (uint32_t*) malloc(ht->capacidade * sizeof(uint32_t));
+    uint32_t* principal = (uint32_t*) malloc(ht->capPistas * sizeof(uint32_t));
+    Relacao** relacoes = (Relacao**) calloc(ht->capPistas, sizeof(Relacao*));
+    const char** nomes = (const char**) malloc(ht->capSuspeitos * sizeof(char*));
+    uint32_t* indice = (uint32_t*) malloc(ht->capIndice * sizeof(uint32_t));
+    if (!pistaDoTexto || !principal || !relacoes || !nomes || !indice) {
+        fprintf(stderr, "Falha ao alocar associações.\n");
+        exit(1);
+    }
+    memcpy(pistaDoTexto, ht->pistaDoTexto, ht->capacidade * sizeof(uint32_t));
+    memcpy(principal, ht->principal, ht->numPistas * sizeof(uint32_t));
+    arenaIniciar(&ht->nos);
+    for (uint32_t p = 0; p < ht->numPistas; ++p) {
+        Relacao** fim = &relacoes[p];
+        for (const Relacao* q = ht->relacoes[p]; q; q = q->prox) {
+            *fim = (Relacao*) arenaAlocar(&ht->nos, sizeof(Relacao));
+            **fim = *q;
+            fim = &(*fim)->prox;
+        }
+        *fim = NULL;
+    }
+    memcpy(nomes, ht->nomesSuspeitos, ht->numSuspeitos * sizeof(char*));
+    memcpy(indice, ht->indiceSuspeitos, ht->capIndice * sizeof(uint32_t));
+    ht->pistaDoTexto = pistaDoTexto;
+    ht->principal = principal;
+    ht->relacoes = relacoes;
+    ht->nomesSuspeitos = nomes;
+    ht->indiceSuspeitos = indice;
+    ht->embutida = 2;
+}
+
+/* garantirSuspeito() – id do suspeito, registrando-o se for novo
+ * (a hash pré-montada é copiada para o heap antes) */
+uint32_t garantirSuspeito(HashTable* ht, const char* nome) {
+    uint32_t id = idSuspeito(ht, nome);
+    if (id != SEM_INDICE) return id;
+    if (ht->embutida == 1) materializarHash(ht);
+    return registrarSuspeito(ht, nome);
+}
+
+/* ------------------------------------------------------------
+ * associarPista() – define o peso (0..PESO_MAX) da relação
+ * pista -> suspeito, sem mexer nas outras relações da pista.
+ * Peso 0 desfaz a relação.
+ * ------------------------------------------------------------ */
+void associarPista(HashTable* ht, const char* pista, const char* suspeito, uint32_t peso) {
+    if (!ht || !pista || !suspeito) return;
+    if (ht->embutida == 1) materializarHash(ht);
+    if (peso > PESO_MAX) peso = PESO_MAX;
+    uint32_t texto = peso ? internarStr(pista) : buscarStr(pista);
+    if (texto == SEM_INDICE || (!peso && indicePista(ht, texto) == SEM_INDICE)) return;
+    uint32_t s = registrarSuspeito(ht, suspeito);
+    uint32_t p = novaPista(ht, texto);
+
+    Relacao** r = &ht->relacoes[p];
+    while (*r && (*r)->suspeito != s) r = &(*r)->prox;
+    if (!*r) {
+        if (!peso) return;
+        *r = (Relacao*) arenaAlocar(&ht->nos, sizeof(Relacao));
+        (*r)->suspeito = s;
+        (*r)->peso = 0;
+        (*r)->prox = NULL;
+    }
+    if (!(*r)->peso && peso) { ht->ocupados++; ESTAT(estatLocal.insercoesHash++); }
+    if ((*r)->peso && !peso) ht->ocupados--;
+    (*r)->peso = peso;
+
+    // principal: maior peso; empate fica com a relação mais antiga
+    uint32_t melhor = SEM_INDICE, maior = 0;
+    for (const Relacao* q = ht->relacoes[p]; q; q = q->prox)
+        if (q->peso > maior) { maior = q->peso; melhor = q->suspeito; }
+    ht->principal[p] = melhor;
+}
+
+/* ------------------------------------------------------------
+ * garantirAssociacao() – associa a pista ao suspeito com 'peso'
+ * só se a relação ainda não existe (um peso já definido é
+ * mantido). É como cenários e snapshots devolvem suas relações
+ * à hash sem atropelar um --associacoes.
+ * ------------------------------------------------------------ */
+void garantirAssociacao(HashTable* ht, const char* pista, const char* suspeito, uint32_t peso) {
+    if (!ht || !pista || !suspeito || !peso) return;
+    uint32_t texto = buscarStr(pista);
+    uint32_t p = texto != SEM_INDICE ? indicePista(ht, texto) : SEM_INDICE;
+    if (p != SEM_INDICE) {
+        uint32_t s = idSuspeito(ht, suspeito);
+        for (const Relacao* r = ht->relacoes[p]; s != SEM_INDICE && r; r = r->prox)
+            if (r->suspeito == s && r->peso) return;
+    }
+    associarPista(ht, pista, suspeito, peso);
+}
+
+/* ------------------------------------------------------------
+ * inserirNaHash() – garante a relação pista/suspeito (peso 1 se
+ * ela ainda não existe). Reinserir a pista com outro suspeito
+ * acrescenta uma relação em vez de substituir a anterior.
+ * ------------------------------------------------------------ */
+void inserirNaHash(HashTable* ht, const char* pista, const char* suspeito) {
+    garantirAssociacao(ht, pista, suspeito, 1);
+}
+
+/* pesoRelacao() – peso da pista p para o suspeito s (0 = nenhum) */
+uint32_t pesoRelacao(const HashTable* ht, uint32_t p, uint32_t s) {
+    if (p >= ht->numPistas) return 0;
+    for (const Relacao* r = ht->relacoes[p]; r; r = r->prox)
+        if (r->suspeito == s) return r->peso;
+    return 0;
+}
+
+/* suspeitoDaPista() – suspeito de maior peso da pista (ou SEM_INDICE) */
+uint32_t suspeitoDaPista(HashTable* ht, const char* pista) {
+    if (!ht || !pista) return SEM_INDICE;
+    uint32_t texto = buscarStr(pista);
+    return texto != SEM_INDICE ? suspeitoDoTexto(ht, texto) : SEM_INDICE;
+}
+
+/* ------------------------------------------------------------
+ * encontrarSuspeito() – retorna o suspeito de maior peso
+ * associado à pista (ou "")
+ * ------------------------------------------------------------ */
+const char* encontrarSuspeito(HashTable* ht, const char* pista) {
+    uint32_t id = suspeitoDaPista(ht, pista);
+    return id != SEM_INDICE ? ht->nomesSuspeitos[id] : "";
+}
+
+/* ------------------------------------------------------------
+ * liberarHash() – os textos ficam no pool (liberarTextos());
+ * BST e mansão são liberadas pelas arenas da sessão e do mapa
+ * ------------------------------------------------------------ */
+void liberarHash(HashTable* ht) {
+    if (!ht || ht->embutida == 1) return;   // pré-montada: nada veio do heap
+    free(ht->pistaDoTexto);
+    free(ht->principal);
+    free(ht->relacoes);
+    arenaLiberar(&ht->nos);
+    free(ht->nomesSuspeitos);
+    free(ht->indiceSuspeitos);
+    if (!ht->embutida) free(ht);
+}
+
+/* ============================================================
+   Contadores de evidência por suspeito (por sessão)
+   Cada pista nova soma um voto ao suspeito dela; 'ordem' é
+   mantida decrescente a cada voto (troca com o primeiro empatado),
+   então veredito e suspeito mais citado são O(1) e o top-k é O(k).
+   ============================================================ */
+
+/* acompanharSuspeitos() – cria contadores para suspeitos que
+ * entraram na hash depois do início da sessão */
+static void acompanharSuspeitos(Sessao* s, const HashTable* ht) {
+    uint32_t n = ht->numSuspeitos;
+    if (n <= s->numSuspeitos) return;
+    if (n > s->capSuspeitos) {
+        uint32_t cap = s->capSuspeitos ? s->capSuspeitos : 8;
+        while (cap < n) cap *= 2;
+        uint32_t* votos   = (uint32_t*) arenaAlocar(&s->arena, cap * sizeof(uint32_t));
+        uint32_t* ordem   = (uint32_t*) arenaAlocar(&s->arena, cap * sizeof(uint32_t));
+        uint32_t* posicao = (uint32_t*) arenaAlocar(&s->arena, cap * sizeof(uint32_t));
+        if (s->numSuspeitos) {
+            memcpy(votos,   s->votos,   s->numSuspeitos * sizeof(uint32_t));
+            memcpy(ordem,   s->ordem,   s->numSuspeitos * sizeof(uint32_t));
+            memcpy(posicao, s->posicao, s->numSuspeitos * sizeof(uint32_t));
+        }
+        s->votos = votos; s->ordem = ordem; s->posicao = posicao;
+        s->capSuspeitos = cap;
+    }
+    // suspeitos novos entram no fim da ordem, com zero votos
+    for (uint32_t id = s->numSuspeitos; id < n; ++id) {
+        s->votos[id] = 0;
+        s->ordem[id] = id;
+        s->posicao[id] = id;
+    }
+    s->numSuspeitos = n;
+}
+
+/* ------------------------------------------------------------
+ * contarVoto() – soma 'peso' votos ao suspeito de uma vez, mantendo
+ * 'ordem' decrescente: uma busca binária pela nova posição (a
+ * primeira com menos votos que o novo total) e um memmove de quem
+ * fica entre ela e a posição antiga. Com peso 1 só há empatados
+ * nesse trecho e o movimento se reduz a uma troca.
+ * ------------------------------------------------------------ */
+static void contarVoto(Sessao* s, uint32_t id, uint32_t peso) {
+    uint32_t novo = s->votos[id] + peso;
+    uint32_t antiga = s->posicao[id];
+    uint32_t lo = 0, hi = antiga;
+    while (lo < hi) {
+        uint32_t meio = lo + (hi - lo) / 2;
+        if (s->votos[s->ordem[meio]] >= novo) lo = meio + 1;
+        else hi = meio;
+    }
+    s->votos[id] = novo;
+    if (lo == antiga) return;
+    if (s->votos[s->ordem[lo]] == novo - peso) {
+        // todos no trecho têm os votos antigos: basta trocar com o primeiro
+        uint32_t outro = s->ordem[lo];
+        s->ordem[antiga] = outro;
+        s->posicao[outro] = antiga;
+    } else {
+        memmove(&s->ordem[lo + 1], &s->ordem[lo], (antiga - lo) * sizeof(uint32_t));
+        for (uint32_t i = lo + 1; i <= antiga; ++i) s->posicao[s->ordem[i]] = i;
+    }
+    s->ordem[lo] = id;
+    s->posicao[id] = lo;
+}
+
+/* creditarPista() – soma o peso de cada relação da pista ao
+ * suspeito correspondente */
+static void creditarPista(Sessao* s, const HashTable* ht, uint32_t p) {
+    acompanharSuspeitos(s, ht);
+    for (const Relacao* r = ht->relacoes[p]; r; r = r->prox)
+        if (r->peso) contarVoto(s, r->suspeito, r->peso);
+}
+
+static int compararChaveDesc(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+/* ------------------------------------------------------------
+ * ordenarVotos() – refaz 'ordem' e 'posicao' de uma vez depois
+ * que os votos foram preenchidos direto (ao retomar uma sessão
+ * salva, com os votos gravados no snapshot)
+ * ------------------------------------------------------------ */
+static void ordenarVotos(Sessao* s) {
+    uint32_t n = s->numSuspeitos;
+    if (!n) return;
+    // chave = votos no alto, id invertido embaixo: empates ficam por id
+    uint64_t* chaves = (uint64_t*) malloc(n * sizeof(uint64_t));
+    if (!chaves) { fprintf(stderr, "Falha ao alocar contadores.\n"); exit(1); }
+    for (uint32_t id = 0; id < n; ++id) chaves[id] = ((uint64_t) s->votos[id] << 32) | (UINT32_MAX - id);
+    qsort(chaves, n, sizeof(uint64_t), compararChaveDesc);
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t id = UINT32_MAX - (uint32_t) chaves[i];
+        s->ordem[i] = id;
+        s->posicao[id] = i;
+    }
+    free(chaves);
+}
+
+/* ------------------------------------------------------------
+ * coletarPistaId() – insere a pista (id do texto no pool) na
+ * árvore da sessão e, se ela for nova (nem na árvore nem entre
+ * as congeladas), credita os suspeitos associados. Retorna 1 se
+ * inseriu.
+ * ------------------------------------------------------------ */
+int coletarPistaId(Sessao* s, HashTable* ht, uint32_t texto) {
+    int nova = 0;
+    ESTAT(estatLocal.insercoesPista++);
+    if (!contemCongelada(&s->congeladas, textoDoId(texto)))
+        s->pistas = inserirPistaId(&s->arena, s->pistas, texto, textoDoId(texto), &nova);
+    RASTRO(RASTRO_PISTA, sessaoRastro(s), texto, (uint32_t) nova);
+    if (!nova) return 0;
+    s->numPistas++;
+    if (s->trigramasProntos) indexarPista(&s->arena, &s->trigramas, texto);
+    uint32_t p = indicePista(ht, texto);
+    if (p != SEM_INDICE) creditarPista(s, ht, p);
+    return 1;
+}
+
+/* coletarPista() – o mesmo, pelo texto da pista */
+int coletarPista(Sessao* s, HashTable* ht, const char* pista) {
+    if (!pista || !*pista) {
+        ESTAT(estatLocal.insercoesPista++);
+        return 0;
+    }
+    return coletarPistaId(s, ht, internarStr(pista));
+}
+
+/* ------------------------------------------------------------
+ * votosPara() – soma dos pesos das pistas coletadas contra o
+ * acusado, em O(1). A acusação é sustentada com soma >=
+ * PESO_SUSTENTA: com as associações padrão (peso 1) são duas
+ * pistas, mas uma só pista de peso 2 já basta.
+ * ------------------------------------------------------------ */
+uint32_t votosPara(const Sessao* s, const HashTable* ht, const char* acusado) {
+    uint32_t id = idSuspeito(ht, acusado);
+    return id < s->numSuspeitos ? s->votos[id] : 0;
+}
+
+/* rastrearJulgamento() – acusação (nome como digitado e suspeito
+ * encontrado) e veredito, no rastro */
+void rastrearJulgamento(Sessao* s, const HashTable* ht, const char* acusado, uint32_t votos) {
+    if (!rastroLigado) return;
+    registrarRastro(RASTRO_ACUSACAO, sessaoRastro(s), internarStr(acusado), idSuspeito(ht, acusado));
+    registrarRastro(RASTRO_VEREDITO, sessaoRastro(s), votos, votos >= PESO_SUSTENTA);
+}
+
+/* ------------------------------------------------------------
+ * suspeitosMaisCitados() – copia até k ids com pelo menos um
+ * voto, do mais citado para o menos; retorna quantos copiou
+ * ------------------------------------------------------------ */
+uint32_t suspeitosMaisCitados(const Sessao* s, uint32_t k, uint32_t* ids) {
+    uint32_t n = 0;
+    while (n < k && n < s->numSuspeitos && s->votos[s->ordem[n]] > 0) {
+        ids[n] = s->ordem[n];
+        n++;
+    }
+    return n;
+}
+
+/* ============================================================
+   Despejo de estatísticas (texto ou JSON)
+   A parte estrutural (ocupação e deslocamentos da hash, tamanho e
+   altura da árvore, memória das arenas) é calculada na hora e
+   existe sempre; os contadores do caminho quente só aparecem em
+   builds com DQ_ESTATISTICAS.
+   ============================================================ */
+typedef struct CampoEstat {
+    const char* chave;
+    double valor;
+    int inteiro;
+} CampoEstat;
+
+#define MAX_CAMPOS_ESTAT 64
+
+typedef struct RelatorioEstat {
+    CampoEstat campos[MAX_CAMPOS_ESTAT];
+    int n;
+} RelatorioEstat;
+
+static void anotar(RelatorioEstat* r, const char* chave, double valor, int inteiro) {
+    if (r->n < MAX_CAMPOS_ESTAT) r->campos[r->n++] = (CampoEstat) { chave, valor, inteiro };
+}
+#define ANOTAR_INT(r, k, v) anotar((r), (k), (double) (v), 1)
+#define ANOTAR_REAL(r, k, v) anotar((r), (k), (v), 0)
+
+static void anotarArena(RelatorioEstat* r, const char* alocs, const char* usados,
+                        const char* reservados, const Arena* a) {
+    ANOTAR_INT(r, alocs, a->numAlocacoes);
+    ANOTAR_INT(r, usados, a->bytesUsados);
+    ANOTAR_INT(r, reservados, a->bytesReservados);
+}
+
+/* ------------------------------------------------------------
+ * despejarEstatisticas() – qualquer argumento pode ser NULL
+ * ------------------------------------------------------------ */
+void despejarEstatisticas(FILE* out, int json, const HashTable* ht, const Arena* mapa, const Sessao* s) {
+    RelatorioEstat r;
+    r.n = 0;
+
+    {
+        // deslocamento de cada texto no índice do pool em relação à
+        // posição ideal (= sondagens extras para achá-lo); faixas
+        // 0,1,2-3,4-7,8-15,16+
+        static const char* const FAIXAS[] = {
+            "pool.deslocamento.0", "pool.deslocamento.1", "pool.deslocamento.2_3",
+            "pool.deslocamento.4_7", "pool.deslocamento.8_15", "pool.deslocamento.16_mais" };
+        uint64_t hist[6] = {0}, soma = 0, maximo = 0;
+        const IndiceTextos* ix = atomic_load(&poolTextos.indice);
+        size_t cap = ix ? ix->capacidade : 0, mascara = cap - 1;
+        uint32_t num = numTextos();
+        for (size_t i = 0; i < cap; ++i) {
+            uint32_t v = atomic_load_explicit(&ix->pos[i], memory_order_relaxed);
+            if (!v) continue;
+            uint64_t d = (i - (entradaTexto(v - 1)->hash & mascara)) & mascara;
+            soma += d;
+            if (d > maximo) maximo = d;
+            int f = d == 0 ? 0 : d == 1 ? 1 : d < 4 ? 2 : d < 8 ? 3 : d < 16 ? 4 : 5;
+            hist[f]++;
+        }
+        size_t blocos = (num + POOL_BLOCO - 1) / POOL_BLOCO;
+        ANOTAR_INT(&r, "pool.textos", num);
+        ANOTAR_INT(&r, "pool.capacidade", cap);
+        ANOTAR_REAL(&r, "pool.carga", cap ? (double) num / cap : 0.0);
+        ANOTAR_REAL(&r, "pool.deslocamento.medio", num ? (double) soma / num : 0.0);
+        ANOTAR_INT(&r, "pool.deslocamento.max", maximo);
+        for (int f = 0; f < 6; ++f) ANOTAR_INT(&r, FAIXAS[f], hist[f]);
+        ANOTAR_INT(&r, "pool.bytes_indice", cap * sizeof(uint32_t));
+        ANOTAR_INT(&r, "pool.bytes_entradas", blocos * POOL_BLOCO * sizeof(EntradaTexto));
+        anotarArena(&r, "pool.textos.alocacoes", "pool.textos.bytes_usados",
+                    "pool.textos.bytes_reservados", &poolTextos.textos);
+    }
+    if (ht) {
+        ANOTAR_INT(&r, "hash.associacoes", ht->ocupados);
+        ANOTAR_INT(&r, "hash.suspeitos", ht->numSuspeitos);
+        ANOTAR_INT(&r, "hash.bytes_tabela", ht->capacidade * sizeof(uint32_t));
+        ANOTAR_INT(&r, "hash.pistas", ht->numPistas);
+        ANOTAR_INT(&r, "hash.bytes_relacoes", ht->nos.bytesReservados);
+    }
+    if (mapa) {
+        anotarArena(&r, "mapa.alocacoes", "mapa.bytes_usados", "mapa.bytes_reservados", mapa);
+    }
+    if (s) {
+        ANOTAR_INT(&r, "sessao.pistas", s->numPistas);
+        ANOTAR_INT(&r, "sessao.altura_arvore", alturaPista(s->pistas));
+        ANOTAR_INT(&r, "sessao.salas_visitadas", s->salasVisitadas);
+        anotarArena(&r, "sessao.alocacoes", "sessao.bytes_usados", "sessao.bytes_reservados", &s->arena);
+    }
+#ifdef DQ_ESTATISTICAS
+    acumularEstatisticas();
+    const Estatisticas* e = &estatGlobal;
+    ANOTAR_INT(&r, "contador.hash.buscas", e->buscasHash);
+    ANOTAR_REAL(&r, "contador.hash.sondagens_por_busca",
+                e->buscasHash ? (double) e->sondagensHash / e->buscasHash : 0.0);
+    ANOTAR_INT(&r, "contador.hash.sondagem_max", e->maxSondagem);
+    ANOTAR_INT(&r, "contador.hash.insercoes", e->insercoesHash);
+    ANOTAR_INT(&r, "contador.hash.crescimentos", e->crescimentosHash);
+    ANOTAR_INT(&r, "contador.pistas.insercoes", e->insercoesPista);
+    ANOTAR_REAL(&r, "contador.pistas.nos_por_insercao",
+                e->insercoesPista ? (double) e->nosPercorridosPista / e->insercoesPista : 0.0);
+    ANOTAR_INT(&r, "contador.pistas.nos_criados", e->pistasCriadas);
+    ANOTAR_INT(&r, "contador.sessoes", e->sessoes);
+    ANOTAR_REAL(&r, "contador.sessoes.salas_media", e->sessoes ? (double) e->salasVisitadas / e->sessoes : 0.0);
+    ANOTAR_INT(&r, "contador.sessoes.salas_max", e->maxSalasSessao);
+    ANOTAR_REAL(&r, "contador.sessoes.pistas_media", e->sessoes ? (double) e->pistasColetadas / e->sessoes : 0.0);
+    ANOTAR_INT(&r, "contador.sessoes.pistas_max", e->maxPistasSessao);
+#endif
+
+    if (json) fputc('{', out);
+    else      fprintf(out, "=== Estatísticas ===\n");
+    for (int i = 0; i < r.n; ++i) {
+        const CampoEstat* c = &r.campos[i];
+        if (json) fprintf(out, "%s\"%s\":", i ? "," : "", c->chave);
+        else      fprintf(out, "%-40s ", c->chave);
+        if (c->inteiro) fprintf(out, "%llu", (unsigned long long) c->valor);
+        else            fprintf(out, "%.4f", c->valor);
+        if (!json) fputc('\n', out);
+    }
+    if (json) fprintf(out, "}\n");
+}
+
+/* ============================================================
+   Popular a tabela hash (pista -> suspeito)
+   (feito uma vez no início)
+   ============================================================ */
+void carregarAssociacoes(HashTable* ht) {
+    // Exemplo de relações (ajuste à narrativa):
+    inserirNaHash(ht, TEXTO_PISTA[PISTA_PEGADA],  "Jardineiro");
+    inserirNaHash(ht, TEXTO_PISTA[PISTA_COPO],    "Mordomo");
+    inserirNaHash(ht, TEXTO_PISTA[PISTA_FACA],    "Cozinheira");
+    inserirNaHash(ht, TEXTO_PISTA[PISTA_LIVRO],   "Bibliotecária");
+    inserirNaHash(ht, TEXTO_PISTA[PISTA_TERRA],   "Jardineiro");
+    inserirNaHash(ht, TEXTO_PISTA[PISTA_BILHETE], "Mordomo");
+    inserirNaHash(ht, TEXTO_PISTA[PISTA_CHAVE],   "Bibliotecária");
+}
+
+#ifdef MANSAO_PADRAO_GERADA
+static uint32_t   pistaDoTextoEmbutida[PADRAO_CAP_TEXTOS_HASH] = PADRAO_PISTA_DO_TEXTO;
+static uint32_t   principalEmbutido[PADRAO_CAP_PISTAS] = PADRAO_PRINCIPAL;
+static Relacao    nosEmbutidos[PADRAO_NUM_RELACOES] = PADRAO_NOS;
+static Relacao*   relacoesEmbutidas[PADRAO_CAP_PISTAS] = PADRAO_RELACOES;
+static const char* nomesEmbutidos[PADRAO_CAP_SUSPEITOS] = PADRAO_NOMES_SUSPEITOS;
+static uint32_t   indiceSuspeitosEmbutido[PADRAO_CAP_INDICE_SUSPEITOS] = PADRAO_INDICE_SUSPEITOS;
+
+static HashTable associacoesEmbutidas = {
+    .pistaDoTexto = pistaDoTextoEmbutida, .capacidade = PADRAO_CAP_TEXTOS_HASH,
+    .principal = principalEmbutido, .relacoes = relacoesEmbutidas,
+    .numPistas = PADRAO_NUM_PISTAS, .capPistas = PADRAO_CAP_PISTAS, .ocupados = PADRAO_OCUPADOS,
+    .nomesSuspeitos = nomesEmbutidos,
+    .numSuspeitos = PADRAO_NUM_SUSPEITOS, .capSuspeitos = PADRAO_CAP_SUSPEITOS,
+    .indiceSuspeitos = indiceSuspeitosEmbutido, .capIndice = PADRAO_CAP_INDICE_SUSPEITOS,
+    .embutida = 1,
+};
+#endif
+
+/* ------------------------------------------------------------
+ * associacoesPadrao() – as associações da mansão padrão: a tabela
+ * estática pré-montada (uma só por processo; é copiada para o heap
+ * na primeira mudança) ou, sem ela, uma tabela nova
+ * ------------------------------------------------------------ */
+HashTable* associacoesPadrao(void) {
+#ifdef MANSAO_PADRAO_GERADA
+    return &associacoesEmbutidas;
+#else
+    HashTable* ht = criarHash(101);
+    carregarAssociacoes(ht);
+    return ht;
+#endif
+}
+
+/* ============================================================
+   ESTRUTURA 4: Cenário binário (arquivo mapeado com mmap)
+   Salas, pistas e suspeitos ficam em vetores planos: filhos e
+   pistas são referenciados por índice e os textos por
+   deslocamento na tabela de strings. O jogo percorre o
+   próprio mapeamento, sem malloc por sala, então abrir um
+   cenário custa o mesmo com 7 ou com 700 mil salas.
+
+   Layout do arquivo (little-endian, tudo alinhado em 4 bytes):
+     CabecalhoCenario | SalaRec[numSalas] | PistaRec[numPistas]
+     | RelacaoRec[numRelacoes] | SuspeitoRec[numSuspeitos]
+     | strings terminadas em '\0'
+   Cada pista aponta para a sua faixa de relações (suspeito e
+   peso), então associações muitos-para-muitos e pesos de um
+   --associacoes sobrevivem à exportação.
+   ============================================================ */
+#define CENARIO_MAGICA  "DQC1"
+#define CENARIO_VERSAO  2u
+
+typedef struct CabecalhoCenario {
+    char     magica[4];
+    uint32_t versao;
+    uint32_t numSalas, numPistas, numSuspeitos;
+    uint32_t raiz;                  // índice da sala inicial
+    uint64_t offSalas, offPistas, offSuspeitos, offStrings;
+    uint64_t tamStrings;
+    uint32_t numRelacoes, reservado;
+    uint64_t offRelacoes;
+} CabecalhoCenario;
+
+typedef struct SalaRec {
+    uint32_t nome;                  // deslocamento na tabela de strings
+    uint32_t esq, dir;              // índices das salas filhas (ou SEM_INDICE)
+    uint32_t pista;                 // índice em PistaRec (ou SEM_INDICE)
+} SalaRec;
+
+typedef struct PistaRec {
+    uint32_t texto;                 // deslocamento na tabela de strings
+    uint32_t suspeito;              // de maior peso, em SuspeitoRec (ou SEM_INDICE)
+    uint32_t relacoes;              // primeira relação em RelacaoRec
+    uint32_t numRelacoes;
+} PistaRec;
+
+typedef struct RelacaoRec {
+    uint32_t suspeito;              // índice em SuspeitoRec
+    uint32_t peso;                  // 1..PESO_MAX
+} RelacaoRec;
+
+typedef struct SuspeitoRec {
+    uint32_t nome;
+} SuspeitoRec;
+
+_Static_assert(sizeof(CabecalhoCenario) == 80, "cabeçalho do cenário deve ter 80 bytes");
+
+typedef struct Cenario {
+    const unsigned char*    base;   // início do mapeamento
+    size_t                  tamanho;
+    const CabecalhoCenario* cab;
+    const SalaRec*          salas;
+    const PistaRec*         pistas;
+    const RelacaoRec*       relacoes;
+    const SuspeitoRec*      suspeitos;
+    const char*             strings;
+} Cenario;
+
+/* ------------------------------------------------------------
+ * secaoValida() – confere se [off, off + n*tamItem) cabe no arquivo
+ * ------------------------------------------------------------ */
+static int secaoValida(uint64_t off, uint64_t n, uint64_t tamItem, size_t total) {
+    if (off % 4 != 0 || off > total) return 0;
+    if (tamItem && n > (total - off) / tamItem) return 0;
+    return 1;
+}
+
+/* ------------------------------------------------------------
+ * abrirCenario() – mapeia o arquivo e valida só o cabeçalho
+ * (as referências de cada sala são checadas ao serem usadas).
+ * Retorna 0 em caso de sucesso, -1 em caso de erro.
+ * ------------------------------------------------------------ */
+int abrirCenario(Cenario* c, const char* caminho) {
+    memset(c, 0, sizeof(*c));
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { fprintf(stderr, "Não foi possível abrir o cenário '%s'.\n", caminho); return -1; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CabecalhoCenario)) {
+        fprintf(stderr, "Cenário '%s' vazio ou ilegível.\n", caminho);
+        close(fd);
+        return -1;
+    }
+    size_t tamanho = (size_t) st.st_size;
+    void* m = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) { fprintf(stderr, "Falha ao mapear o cenário '%s'.\n", caminho); return -1; }
+
+    const CabecalhoCenario* cab = (const CabecalhoCenario*) m;
+    const unsigned char* base = (const unsigned char*) m;
+    int ok = memcmp(cab->magica, CENARIO_MAGICA, 4) == 0
+          && cab->versao == CENARIO_VERSAO
+          && secaoValida(cab->offSalas, cab->numSalas, sizeof(SalaRec), tamanho)
+          && secaoValida(cab->offPistas, cab->numPistas, sizeof(PistaRec), tamanho)
+          && secaoValida(cab->offRelacoes, cab->numRelacoes, sizeof(RelacaoRec), tamanho)
+          && secaoValida(cab->offSuspeitos, cab->numSuspeitos, sizeof(SuspeitoRec), tamanho)
+          && secaoValida(cab->offStrings, cab->tamStrings, 1, tamanho)
+          && cab->tamStrings > 0
+          && base[cab->offStrings + cab->tamStrings - 1] == '\0'
+          && cab->numSalas > 0 && cab->raiz < cab->numSalas;
+    if (!ok) {
+        fprintf(stderr, "Cenário '%s' inválido ou de versão incompatível.\n", caminho);
+        munmap(m, tamanho);
+        return -1;
+    }
+
+    c->base      = base;
+    c->tamanho   = tamanho;
+    c->cab       = cab;
+    c->salas     = (const SalaRec*)     (base + cab->offSalas);
+    c->pistas    = (const PistaRec*)    (base + cab->offPistas);
+    c->relacoes  = (const RelacaoRec*)  (base + cab->offRelacoes);
+    c->suspeitos = (const SuspeitoRec*) (base + cab->offSuspeitos);
+    c->strings   = (const char*)        (base + cab->offStrings);
+    return 0;
+}
+
+void fecharCenario(Cenario* c) {
+    if (c && c->base) munmap((void*) c->base, c->tamanho);
+    if (c) memset(c, 0, sizeof(*c));
+}
+
+/* ------------------------------------------------------------
+ * Acessores do cenário – devolvem "" / SEM_INDICE para
+ * referências fora dos limites em vez de ler lixo.
+ * ------------------------------------------------------------ */
+const char* stringCenario(const Cenario* c, uint32_t off) {
+    return off < c->cab->tamStrings ? c->strings + off : "";
+}
+
+uint32_t filhoCenario(const Cenario* c, uint32_t sala, char lado) {
+    uint32_t f = (lado == 'e') ? c->salas[sala].esq : c->salas[sala].dir;
+    return f < c->cab->numSalas ? f : SEM_INDICE;
+}
+
+const char* nomeSalaCenario(const Cenario* c, uint32_t sala) {
+    return stringCenario(c, c->salas[sala].nome);
+}
+
+const char* pistaSalaCenario(const Cenario* c, uint32_t sala) {
+    uint32_t p = c->salas[sala].pista;
+    return p < c->cab->numPistas ? stringCenario(c, c->pistas[p].texto) : "";
+}
+
+const char* suspeitoPistaCenario(const Cenario* c, uint32_t sala) {
+    uint32_t p = c->salas[sala].pista;
+    if (p >= c->cab->numPistas) return "";
+    uint32_t s = c->pistas[p].suspeito;
+    return s < c->cab->numSuspeitos ? stringCenario(c, c->suspeitos[s].nome) : "";
+}
+
+/* registrarSuspeitosCenario() – registra os suspeitos do cenário
+ * na ordem do arquivo (a mesma ordem de ids da hash exportada) */
+void registrarSuspeitosCenario(HashTable* ht, const Cenario* c) {
+    for (uint32_t s = 0; s < c->cab->numSuspeitos; ++s) {
+        const char* nome = stringCenario(c, c->suspeitos[s].nome);
+        if (*nome) garantirSuspeito(ht, nome);
+    }
+}
+
+/* ------------------------------------------------------------
+ * associarPistaCenario() – leva para a hash todas as relações da
+ * pista 'p' do cenário, com seus pesos (sem mexer em relações
+ * que a hash já tem). Faixas fora dos limites são ignoradas.
+ * ------------------------------------------------------------ */
+void associarPistaCenario(HashTable* ht, const Cenario* c, uint32_t p) {
+    if (p >= c->cab->numPistas) return;
+    const PistaRec* pr = &c->pistas[p];
+    if (pr->relacoes > c->cab->numRelacoes || pr->numRelacoes > c->cab->numRelacoes - pr->relacoes) return;
+    const char* texto = stringCenario(c, pr->texto);
+    for (uint32_t k = 0; k < pr->numRelacoes; ++k) {
+        const RelacaoRec* r = &c->relacoes[pr->relacoes + k];
+        if (r->suspeito < c->cab->numSuspeitos)
+            garantirAssociacao(ht, texto, stringCenario(c, c->suspeitos[r->suspeito].nome), r->peso);
+    }
+}
+
+/* ------------------------------------------------------------
+ * exportarCenario() – grava a mansão montada em main() no
+ * formato binário (salas em largura, a partir da raiz).
+ * Retorna 0 em caso de sucesso, -1 em caso de erro.
+ * ------------------------------------------------------------ */
+typedef struct TextoBuf {
+    char*  dados;
+    size_t tam, cap;
+} TextoBuf;
+
+static uint32_t anexarTexto(TextoBuf* b, const char* s) {
+    size_t n = strlen(s) + 1;
+    if (b->tam + n > b->cap) {
+        size_t nova = b->cap ? b->cap * 2 : 256;
+        while (nova < b->tam + n) nova *= 2;
+        char* d = (char*) realloc(b->dados, nova);
+        if (!d) { fprintf(stderr, "Falha ao alocar tabela de strings.\n"); exit(1); }
+        b->dados = d;
+        b->cap = nova;
+    }
+    memcpy(b->dados + b->tam, s, n);
+    uint32_t off = (uint32_t) b->tam;
+    b->tam += n;
+    return off;
+}
+
+typedef struct RelacoesBuf {
+    RelacaoRec* v;
+    uint32_t    n, cap;
+} RelacoesBuf;
+
+static void anexarRelacao(RelacoesBuf* b, uint32_t suspeito, uint32_t peso) {
+    if (b->n == b->cap) {
+        b->cap = b->cap ? b->cap * 2 : 64;
+        RelacaoRec* v = (RelacaoRec*) realloc(b->v, b->cap * sizeof(RelacaoRec));
+        if (!v) { fprintf(stderr, "Falha ao alocar relações.\n"); exit(1); }
+        b->v = v;
+    }
+    b->v[b->n].suspeito = suspeito;
+    b->v[b->n].peso = peso;
+    b->n++;
+}
+
+/* anexarSuspeitos() – todos os suspeitos da hash, na ordem dos
+ * ids: o índice em SuspeitoRec é o próprio id, e quem carrega o
+ * arquivo os registra na mesma ordem */
+static SuspeitoRec* anexarSuspeitos(const HashTable* ht, TextoBuf* txt) {
+    SuspeitoRec* susp = (SuspeitoRec*) malloc((ht->numSuspeitos ? ht->numSuspeitos : 1) * sizeof(SuspeitoRec));
+    if (!susp) { fprintf(stderr, "Falha ao alocar suspeitos.\n"); exit(1); }
+    for (uint32_t i = 0; i < ht->numSuspeitos; ++i) susp[i].nome = anexarTexto(txt, nomeSuspeito(ht, i));
+    return susp;
+}
+
+/* anexarRelacoes() – grava em 'b' as relações da pista de texto
+ * 'texto' (pesos > 0, na ordem da hash) e preenche a faixa e o
+ * suspeito principal de 'pr' */
+static void anexarRelacoes(RelacoesBuf* b, PistaRec* pr, const HashTable* ht, uint32_t texto) {
+    uint32_t p = texto != SEM_INDICE ? indicePista(ht, texto) : SEM_INDICE;
+    pr->relacoes = b->n;
+    pr->numRelacoes = 0;
+    pr->suspeito = SEM_INDICE;
+    if (p == SEM_INDICE) return;
+    pr->suspeito = ht->principal[p];
+    for (const Relacao* r = ht->relacoes[p]; r; r = r->prox) {
+        if (!r->peso) continue;
+        anexarRelacao(b, r->suspeito, r->peso);
+        pr->numRelacoes++;
+    }
+}
+
+/* contarSalas() – pilha explícita: mapas degenerados podem ter
+ * profundidade igual ao número de salas */
+static size_t contarSalas(const Sala* r) {
+    if (!r) return 0;
+    size_t cap = 64, topo = 0, n = 0;
+    const Sala** pilha = (const Sala**) malloc(cap * sizeof(Sala*));
+    if (!pilha) { fprintf(stderr, "Falha ao alocar pilha.\n"); exit(1); }
+    pilha[topo++] = r;
+    while (topo) {
+        const Sala* s = pilha[--topo];
+        n++;
+        if (topo + 2 > cap) {
+            cap *= 2;
+            const Sala** nova = (const Sala**) realloc(pilha, cap * sizeof(Sala*));
+            if (!nova) { fprintf(stderr, "Falha ao alocar pilha.\n"); exit(1); }
+            pilha = nova;
+        }
+        if (s->esquerda) pilha[topo++] = s->esquerda;
+        if (s->direita)  pilha[topo++] = s->direita;
+    }
+    free(pilha);
+    return n;
+}
+
+int exportarCenario(const char* caminho, Sala* raiz, HashTable* ht) {
+    size_t n = contarSalas(raiz);
+    if (n == 0) return -1;
+
+    Sala**       fila  = (Sala**)       malloc(n * sizeof(Sala*));
+    SalaRec*     salas = (SalaRec*)     malloc(n * sizeof(SalaRec));
+    PistaRec*    pistas = (PistaRec*)   malloc(n * sizeof(PistaRec));
+    if (!fila || !salas || !pistas) { fprintf(stderr, "Falha ao alocar exportação.\n"); exit(1); }
+    TextoBuf txt = {0};
+    RelacoesBuf rel = {0};
+    SuspeitoRec* susp = anexarSuspeitos(ht, &txt);
+    uint32_t numPistas = 0, numSusp = ht->numSuspeitos;
+    uint32_t indicePista[NUM_PISTAS_PADRAO];   // id da pista -> índice no arquivo
+    for (int i = 0; i < NUM_PISTAS_PADRAO; ++i) indicePista[i] = SEM_INDICE;
+
+    // BFS: a posição na fila é o índice da sala no arquivo
+    size_t ini = 0, fim = 0;
+    fila[fim++] = raiz;
+    while (ini < fim) {
+        Sala* s = fila[ini];
+        SalaRec* rec = &salas[ini];
+        ini++;
+        rec->nome = anexarTexto(&txt, nomeSala(s));
+        rec->esq = rec->dir = rec->pista = SEM_INDICE;
+        if (s->esquerda) { rec->esq = (uint32_t) fim; fila[fim++] = s->esquerda; }
+        if (s->direita)  { rec->dir = (uint32_t) fim; fila[fim++] = s->direita; }
+
+        const char* p = textoPista(s->pista);
+        if (!*p) continue;
+        uint32_t ip = indicePista[s->pista];
+        if (ip == SEM_INDICE) {
+            ip = indicePista[s->pista] = numPistas;
+            pistas[numPistas].texto = anexarTexto(&txt, p);
+            anexarRelacoes(&rel, &pistas[numPistas], ht, buscarStr(p));
+            numPistas++;
+        }
+        rec->pista = ip;
+    }
+    while (txt.tam % 4) anexarTexto(&txt, "");   // preenche até alinhar
+
+    CabecalhoCenario cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magica, CENARIO_MAGICA, 4);
+    cab.versao       = CENARIO_VERSAO;
+    cab.numSalas     = (uint32_t) n;
+    cab.numPistas    = numPistas;
+    cab.numSuspeitos = numSusp;
+    cab.raiz         = 0;
+    cab.numRelacoes  = rel.n;
+    cab.offSalas     = sizeof(cab);
+    cab.offPistas    = cab.offSalas + n * sizeof(SalaRec);
+    cab.offRelacoes  = cab.offPistas + numPistas * sizeof(PistaRec);
+    cab.offSuspeitos = cab.offRelacoes + rel.n * sizeof(RelacaoRec);
+    cab.offStrings   = cab.offSuspeitos + numSusp * sizeof(SuspeitoRec);
+    cab.tamStrings   = txt.tam;
+
+    int rc = -1;
+    FILE* f = fopen(caminho, "wb");
+    if (f) {
+        int ok = fwrite(&cab, sizeof(cab), 1, f) == 1
+              && fwrite(salas, sizeof(SalaRec), n, f) == n
+              && fwrite(pistas, sizeof(PistaRec), numPistas, f) == numPistas
+              && fwrite(rel.v, sizeof(RelacaoRec), rel.n, f) == rel.n
+              && fwrite(susp, sizeof(SuspeitoRec), numSusp, f) == numSusp
+              && fwrite(txt.dados, 1, txt.tam, f) == txt.tam;
+        if (fclose(f) == 0 && ok) rc = 0;
+    }
+    if (rc != 0) fprintf(stderr, "Falha ao gravar o cenário '%s'.\n", caminho);
+
+    free(fila); free(salas); free(pistas); free(susp); free(rel.v); free(txt.dados);
+    return rc;
+}
+
+/* ============================================================
+   ESTRUTURA 5: Snapshot de sessão (pausar e retomar)
+   Guarda as pistas coletadas (em ordem A-Z, com as relações de
+   cada uma e seus pesos), os votos de cada suspeito, a sala onde
+   o jogador parou e o contador de salas. A sala é o índice em
+   largura a partir da raiz, o mesmo usado pelo cenário
+   exportado, então o snapshot vale tanto para a mansão padrão
+   quanto para um cenário.
+
+   Layout (little-endian, mesmo esquema do cenário):
+     CabecalhoSnapshot | PistaCongelada[numPistas]
+     | RelacaoRec[numRelacoes] | SuspeitoSnapshot[numSuspeitos]
+     | strings terminadas em '\0'
+   Cada pista já traz o seu prefixo de 8 bytes, e a ordem A-Z é
+   conferida ao gravar. Retomar é validar o cabeçalho e manter o
+   arquivo mapeado: as pistas viram as congeladas da sessão
+   (ESTRUTURA 2) e os votos vêm prontos, sem passar pista por
+   pista pelo pool, pela árvore ou pela hash. Como no cenário,
+   as referências de cada registro são checadas no uso.
+   Os votos só valem para o mapa e as associações com que foram
+   contados: o cabeçalho guarda uma impressão (hash de 64 bits)
+   de cada um, e o snapshot é recusado se não baterem.
+   ============================================================ */
+#define SNAPSHOT_MAGICA "DQS1"
+#define SNAPSHOT_VERSAO 4u
+
+typedef struct CabecalhoSnapshot {
+    char     magica[4];
+    uint32_t versao;
+    uint32_t numPistas, numSuspeitos;
+    uint32_t numSalas;              // salas do mapa em que a sessão foi salva
+    uint32_t salaAtual;             // índice (em largura) da sala onde parou
+    uint32_t salasVisitadas;        // sem contar a sala atual
+    uint32_t numRelacoes;
+    uint64_t offPistas, offSuspeitos, offStrings, tamStrings;
+    uint64_t offRelacoes;
+    uint64_t impressaoMapa;         // impressaoMansao() ou impressaoCenario()
+    uint64_t impressaoAssociacoes;  // impressaoAssociacoes() antes do jogo
+} CabecalhoSnapshot;
+
+typedef struct SuspeitoSnapshot {
+    uint32_t nome;
+    uint32_t votos;                 // peso das pistas coletadas contra ele
+} SuspeitoSnapshot;
+
+_Static_assert(sizeof(CabecalhoSnapshot) == 88, "cabeçalho do snapshot deve ter 88 bytes");
+_Static_assert(sizeof(PistaCongelada) == 24, "pista do snapshot deve ter 24 bytes");
+
+/* ------------------------------------------------------------
+ * indiceDaSala() / salaDoIndice() – conversão entre Sala* e o
+ * índice em largura (a posição na fila da BFS)
+ * ------------------------------------------------------------ */
+static Sala* percorrerLargura(Sala* raiz, const Sala* alvo, uint32_t indice, uint32_t* achado) {
+    size_t n = contarSalas(raiz);
+    Sala** fila = (Sala**) malloc((n ? n : 1) * sizeof(Sala*));
+    if (!fila) { fprintf(stderr, "Falha ao alocar fila.\n"); exit(1); }
+    Sala* r = NULL;
+    size_t ini = 0, fim = 0;
+    if (raiz) fila[fim++] = raiz;
+    while (ini < fim) {
+        Sala* s = fila[ini];
+        if (s == alvo || ini == indice) { r = s; *achado = (uint32_t) ini; break; }
+        ini++;
+        if (s->esquerda) fila[fim++] = s->esquerda;
+        if (s->direita)  fila[fim++] = s->direita;
+    }
+    free(fila);
+    return r;
+}
+
+uint32_t indiceDaSala(Sala* raiz, const Sala* sala) {
+    uint32_t i = SEM_INDICE;
+    percorrerLargura(raiz, sala, SEM_INDICE, &i);
+    return i;
+}
+
+Sala* salaDoIndice(Sala* raiz, uint32_t indice) {
+    uint32_t i;
+    return percorrerLargura(raiz, NULL, indice, &i);
+}
+
+/* ------------------------------------------------------------
+ * Impressões do mapa e das associações, conferidas ao retomar.
+ * O chamador as calcula uma vez, antes do jogo (no cenário, a
+ * hash ganha relações conforme as pistas são coletadas), e as
+ * passa em OrigemSnapshot para salvarSessao()/retomarSessao().
+ * ------------------------------------------------------------ */
+typedef struct OrigemSnapshot {
+    uint32_t numSalas;
+    uint64_t mapa, associacoes;
+} OrigemSnapshot;
+
+/* misturarBytes() – acumula n bytes na impressão h, como hash_rapido() */
+static uint64_t misturarBytes(uint64_t h, const void* dados, size_t n) {
+    const unsigned char* p = (const unsigned char*) dados;
+    h ^= n * 0xff51afd7ed558ccdull;
+    while (n >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = misturar64(h ^ w) * 0x9e3779b97f4a7c15ull;
+        p += 8; n -= 8;
+    }
+    uint64_t w = 0;
+    memcpy(&w, p, n);
+    return misturar64(h ^ w) * 0x9e3779b97f4a7c15ull;
+}
+
+/* impressaoMansao() – nome, pista e filhos de cada sala, em largura */
+uint64_t impressaoMansao(Sala* raiz) {
+    size_t n = contarSalas(raiz);
+    Sala** fila = (Sala**) malloc((n ? n : 1) * sizeof(Sala*));
+    if (!fila) { fprintf(stderr, "Falha ao alocar fila.\n"); exit(1); }
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    size_t ini = 0, fim = 0;
+    if (raiz) fila[fim++] = raiz;
+    while (ini < fim) {
+        Sala* s = fila[ini++];
+        const char* nome = nomeSala(s);
+        const char* pista = textoPista(s->pista);
+        unsigned char filhos = (unsigned char) ((s->esquerda ? 1 : 0) | (s->direita ? 2 : 0));
+        h = misturarBytes(h, nome, strlen(nome));
+        h = misturarBytes(h, pista, strlen(pista));
+        h = misturarBytes(h, &filhos, 1);
+        if (s->esquerda) fila[fim++] = s->esquerda;
+        if (s->direita)  fila[fim++] = s->direita;
+    }
+    free(fila);
+    return h;
+}
+
+/* impressaoCenario() – o arquivo inteiro (salas, pistas e relações
+ * embutidas); O(tamanho do cenário), só ao salvar ou retomar */
+uint64_t impressaoCenario(const Cenario* c) {
+    return misturarBytes(0x9e3779b97f4a7c15ull, c->base, c->tamanho);
+}
+
+/* impressaoAssociacoes() – soma de um hash por relação (texto da
+ * pista, nome do suspeito dobrado, peso): não depende da ordem de
+ * inserção nem dos ids de texto e de suspeito */
+uint64_t impressaoAssociacoes(const HashTable* ht) {
+    uint64_t total = 0;
+    for (size_t t = 0; t < ht->capacidade; ++t) {
+        uint32_t p = ht->pistaDoTexto[t];
+        if (p == SEM_INDICE || p >= ht->numPistas) continue;
+        const char* texto = textoDoId((uint32_t) t);
+        uint64_t hp = (uint64_t) hash_rapido(texto, strlen(texto)) << 32;
+        for (const Relacao* r = ht->relacoes[p]; r; r = r->prox) {
+            if (!r->peso) continue;
+            uint64_t x = (hp | hashSuspeito(nomeSuspeito(ht, r->suspeito))) ^ ((uint64_t) r->peso * 0xd6e8feb86659fd93ull);
+            total += misturar64(x) * 0x9e3779b97f4a7c15ull;
+        }
+    }
+    return total;
+}
+
+/* ------------------------------------------------------------
+ * Pistas congeladas de uma sessão retomada: relações e suspeito
+ * principal vêm do snapshot mapeado, com os suspeitos traduzidos
+ * para ids da hash (SEM_INDICE quando a referência é inválida)
+ * ------------------------------------------------------------ */
+static const CabecalhoSnapshot* snapshotRetomado(const Sessao* s) {
+    return (const CabecalhoSnapshot*) s->mapaRetomado;
+}
+
+static uint32_t suspeitoRetomado(const Sessao* s, uint32_t indice) {
+    return indice < snapshotRetomado(s)->numSuspeitos ? s->suspeitosRetomados[indice] : SEM_INDICE;
+}
+
+/* suspeitoDaCongelada() – nome do suspeito de maior peso da
+ * i-ésima pista congelada (ou "") */
+const char* suspeitoDaCongelada(const Sessao* s, const HashTable* ht, uint32_t i) {
+    uint32_t id = suspeitoRetomado(s, s->congeladas.v[i].suspeito);
+    return id != SEM_INDICE ? nomeSuspeito(ht, id) : "";
+}
+
+/* anexarRelacoesCongelada() – como anexarRelacoes(), para a
+ * i-ésima pista congelada */
+static void anexarRelacoesCongelada(RelacoesBuf* b, PistaRec* pr, const Sessao* s, uint32_t i) {
+    const CabecalhoSnapshot* cab = snapshotRetomado(s);
+    const RelacaoRec* rels = (const RelacaoRec*) ((const unsigned char*) s->mapaRetomado + cab->offRelacoes);
+    const PistaCongelada* pc = &s->congeladas.v[i];
+    pr->relacoes = b->n;
+    pr->numRelacoes = 0;
+    pr->suspeito = suspeitoRetomado(s, pc->suspeito);
+    if (pc->relacoes > cab->numRelacoes || pc->numRelacoes > cab->numRelacoes - pc->relacoes) return;
+    for (uint32_t k = 0; k < pc->numRelacoes; ++k) {
+        const RelacaoRec* r = &rels[pc->relacoes + k];
+        uint32_t id = suspeitoRetomado(s, r->suspeito);
+        if (id == SEM_INDICE || !r->peso) continue;
+        anexarRelacao(b, id, r->peso);
+        pr->numRelacoes++;
+    }
+}
+
+/* pesoCongelada() – peso da i-ésima pista congelada para o
+ * suspeito 'id' da hash, pelas relações gravadas no snapshot */
+static uint32_t pesoCongelada(const Sessao* s, uint32_t i, uint32_t id) {
+    const CabecalhoSnapshot* cab = snapshotRetomado(s);
+    const RelacaoRec* rels = (const RelacaoRec*) ((const unsigned char*) s->mapaRetomado + cab->offRelacoes);
+    const PistaCongelada* pc = &s->congeladas.v[i];
+    if (pc->relacoes > cab->numRelacoes || pc->numRelacoes > cab->numRelacoes - pc->relacoes) return 0;
+    for (uint32_t k = 0; k < pc->numRelacoes; ++k)
+        if (suspeitoRetomado(s, rels[pc->relacoes + k].suspeito) == id) return rels[pc->relacoes + k].peso;
+    return 0;
+}
+
+/* ------------------------------------------------------------
+ * contarPistasParaSuspeito() – referência de votosPara() por
+ * varredura completa: soma, para o acusado, o peso de cada pista
+ * da sessão (árvore e congeladas, pelo cursor), relendo as
+ * relações da hash e as do snapshot. Dá o mesmo que o contador
+ * enquanto as relações não mudarem; O(pistas · relações).
+ * ------------------------------------------------------------ */
+uint32_t contarPistasParaSuspeito(const Sessao* s, const HashTable* ht, const char* acusado) {
+    // o nome do acusado é comparado uma vez só
+    uint32_t id = idSuspeito(ht, acusado);
+    if (id == SEM_INDICE) return 0;
+    CursorPistas c;
+    const char* p;
+    uint32_t total = 0;
+    cursorSessao(&c, s);
+    while ((p = cursorProxima(&c)) != NULL) {
+        if (c.ultimaCongelada != SEM_INDICE) {
+            total += pesoCongelada(s, c.ultimaCongelada, id);
+        } else {
+            uint32_t texto = buscarStr(p);
+            total += texto != SEM_INDICE ? pesoRelacao(ht, indicePista(ht, texto), id) : 0;
+        }
+    }
+    return total;
+}
+
+/* ------------------------------------------------------------
+ * salvarSessao() – grava o snapshot (num arquivo temporário
+ * renomeado no fim, para nunca deixar um snapshot pela metade).
+ * 'salaAtual' já foi contada em salasVisitadas e será visitada
+ * de novo ao retomar. Retorna 0 em caso de sucesso, -1 em erro.
+ * ------------------------------------------------------------ */
+int salvarSessao(const char* caminho, const Sessao* s, HashTable* ht, uint32_t salaAtual, const OrigemSnapshot* origem) {
+    uint32_t n = (uint32_t) s->numPistas, numSusp = ht->numSuspeitos;
+    PistaCongelada*   pistas = (PistaCongelada*)   malloc((n ? n : 1) * sizeof(PistaCongelada));
+    SuspeitoSnapshot* susp   = (SuspeitoSnapshot*) malloc((numSusp ? numSusp : 1) * sizeof(SuspeitoSnapshot));
+    if (!pistas || !susp) { fprintf(stderr, "Falha ao alocar snapshot.\n"); exit(1); }
+
+    // suspeitos na ordem dos ids, como em anexarSuspeitos()
+    TextoBuf txt = {0};
+    RelacoesBuf rel = {0};
+    for (uint32_t i = 0; i < numSusp; ++i) {
+        susp[i].nome = anexarTexto(&txt, nomeSuspeito(ht, i));
+        susp[i].votos = i < s->numSuspeitos ? s->votos[i] : 0;
+    }
+
+    // a ordem A-Z é conferida aqui: retomarSessao() confia nela
+    uint32_t k = 0;
+    int emOrdem = 1;
+    CursorPistas cur;
+    const char *p, *anterior = NULL;
+    cursorSessao(&cur, s);
+    while (emOrdem && (p = cursorProxima(&cur)) != NULL && k < n) {
+        PistaRec pr;
+        if (cur.ultimaCongelada != SEM_INDICE) anexarRelacoesCongelada(&rel, &pr, s, cur.ultimaCongelada);
+        else                                   anexarRelacoes(&rel, &pr, ht, buscarStr(p));
+        pistas[k].prefixo     = prefixoTexto(p);
+        pistas[k].texto       = anexarTexto(&txt, p);
+        pistas[k].suspeito    = pr.suspeito;
+        pistas[k].relacoes    = pr.relacoes;
+        pistas[k].numRelacoes = pr.numRelacoes;
+        emOrdem = !anterior || strcmp(anterior, p) < 0;
+        anterior = p;
+        k++;
+    }
+    anexarTexto(&txt, "");
+    while (txt.tam % 4) anexarTexto(&txt, "");   // preenche até alinhar
+
+    CabecalhoSnapshot cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magica, SNAPSHOT_MAGICA, 4);
+    cab.versao         = SNAPSHOT_VERSAO;
+    cab.numPistas      = k;
+    cab.numSuspeitos   = numSusp;
+    cab.numSalas       = origem->numSalas;
+    cab.salaAtual      = salaAtual;
+    cab.salasVisitadas = s->salasVisitadas ? s->salasVisitadas - 1 : 0;
+    cab.numRelacoes    = rel.n;
+    cab.offPistas      = sizeof(cab);
+    cab.offRelacoes    = cab.offPistas + k * sizeof(PistaCongelada);
+    cab.offSuspeitos   = cab.offRelacoes + rel.n * sizeof(RelacaoRec);
+    cab.offStrings     = cab.offSuspeitos + numSusp * sizeof(SuspeitoSnapshot);
+    cab.tamStrings     = txt.tam;
+    cab.impressaoMapa        = origem->mapa;
+    cab.impressaoAssociacoes = origem->associacoes;
+
+    int rc = -1;
+    size_t tamCaminho = strlen(caminho) + 5;
+    char* temp = (char*) malloc(tamCaminho);
+    if (!temp) { fprintf(stderr, "Falha ao alocar snapshot.\n"); exit(1); }
+    snprintf(temp, tamCaminho, "%s.tmp", caminho);
+    FILE* f = emOrdem ? fopen(temp, "wb") : NULL;
+    if (f) {
+        int ok = fwrite(&cab, sizeof(cab), 1, f) == 1
+              && fwrite(pistas, sizeof(PistaCongelada), k, f) == k
+              && fwrite(rel.v, sizeof(RelacaoRec), rel.n, f) == rel.n
+              && fwrite(susp, sizeof(SuspeitoSnapshot), numSusp, f) == numSusp
+              && fwrite(txt.dados, 1, txt.tam, f) == txt.tam;
+        if (fclose(f) == 0 && ok && rename(temp, caminho) == 0) rc = 0;
+        else unlink(temp);
+    }
+    if (rc != 0) fprintf(stderr, "Falha ao gravar o snapshot '%s'.\n", caminho);
+
+    free(temp); free(pistas); free(susp); free(rel.v); free(txt.dados);
+    return rc;
+}
+
+/* ------------------------------------------------------------
+ * retomarSessao() – reinicia a sessão e a recarrega do snapshot,
+ * em tempo constante: só o cabeçalho é validado; as pistas ficam
+ * no arquivo mapeado (até o próximo reinício da sessão) e os
+ * votos são copiados. Suspeitos que a hash ainda não conhece são
+ * registrados. O snapshot é recusado se o mapa ou as associações
+ * não forem os de 'origem'. Em *salaAtual fica o índice da sala
+ * onde o jogador parou. Retorna 0 em caso de sucesso, -1 em erro.
+ * ------------------------------------------------------------ */
+int retomarSessao(const char* caminho, Sessao* s, HashTable* ht, const OrigemSnapshot* origem, uint32_t* salaAtual) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { fprintf(stderr, "Não foi possível abrir o snapshot '%s'.\n", caminho); return -1; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(CabecalhoSnapshot)) {
+        fprintf(stderr, "Snapshot '%s' vazio ou ilegível.\n", caminho);
+        close(fd);
+        return -1;
+    }
+    size_t tamanho = (size_t) st.st_size;
+    void* m = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) { fprintf(stderr, "Falha ao mapear o snapshot '%s'.\n", caminho); return -1; }
+
+    const unsigned char* base = (const unsigned char*) m;
+    const CabecalhoSnapshot* cab = (const CabecalhoSnapshot*) m;
+    int ok = memcmp(cab->magica, SNAPSHOT_MAGICA, 4) == 0
+          && cab->versao == SNAPSHOT_VERSAO
+          && cab->offPistas % 8 == 0
+          && secaoValida(cab->offPistas, cab->numPistas, sizeof(PistaCongelada), tamanho)
+          && secaoValida(cab->offRelacoes, cab->numRelacoes, sizeof(RelacaoRec), tamanho)
+          && secaoValida(cab->offSuspeitos, cab->numSuspeitos, sizeof(SuspeitoSnapshot), tamanho)
+          && secaoValida(cab->offStrings, cab->tamStrings, 1, tamanho)
+          && cab->tamStrings > 0
+          && base[cab->offStrings + cab->tamStrings - 1] == '\0'
+          && cab->salaAtual < cab->numSalas;
+    const char* erro = !ok ? "inválido ou corrompido"
+                     : cab->numSalas != origem->numSalas || cab->impressaoMapa != origem->mapa
+                     ? "de outro mapa"
+                     : cab->impressaoAssociacoes != origem->associacoes ? "de outras associações" : NULL;
+    if (erro) {
+        fprintf(stderr, "Snapshot '%s' %s.\n", caminho, erro);
+        munmap(m, tamanho);
+        return -1;
+    }
+
+    reiniciarSessao(s);
+    const SuspeitoSnapshot* susp = (const SuspeitoSnapshot*) (base + cab->offSuspeitos);
+    const char*             strs = (const char*)             (base + cab->offStrings);
+    uint32_t* ids = (uint32_t*) arenaAlocar(&s->arena, (cab->numSuspeitos ? cab->numSuspeitos : 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < cab->numSuspeitos; ++i)
+        ids[i] = susp[i].nome < cab->tamStrings && strs[susp[i].nome]
+               ? garantirSuspeito(ht, strs + susp[i].nome) : SEM_INDICE;
+    acompanharSuspeitos(s, ht);
+    for (uint32_t i = 0; i < cab->numSuspeitos; ++i)
+        if (ids[i] != SEM_INDICE) s->votos[ids[i]] = susp[i].votos;
+    ordenarVotos(s);
+
+    s->congeladas.v         = (const PistaCongelada*) (base + cab->offPistas);
+    s->congeladas.n         = cab->numPistas;
+    s->congeladas.textos    = strs;
+    s->congeladas.tamTextos = cab->tamStrings;
+    s->mapaRetomado         = m;
+    s->tamRetomado          = tamanho;
+    s->suspeitosRetomados   = ids;
+    s->numPistas            = cab->numPistas;
+    s->salasVisitadas       = cab->salasVisitadas;
+    *salaAtual = cab->salaAtual;
+    return 0;
+}
+
+/* ============================================================
+   ESTRUTURA 6: Índice de caminhos das salas
+   Montado uma vez, depois de carregar o mapa. Salas são
+   identificadas pelo índice em largura (o mesmo do cenário
+   exportado e do snapshot). Guarda, por sala: pai, profundidade,
+   lado (esquerda/direita) e o topo da sua cadeia na decomposição
+   heavy-light (cada sala continua pela filha de subárvore maior).
+   O que a subida por cadeias lê fica junto num registro de 16
+   bytes por sala (um acesso à memória por cadeia cruzada).
+   Com isso:
+   - sala pelo nome: acesso direto pelo id do nome no pool, O(1);
+   - caminho desde a raiz: sobe pelos pais, O(profundidade);
+   - ancestral comum e distância: sobe cadeia por cadeia, e
+     qualquer caminho cruza no máximo log2(n) cadeias.
+   Nada é recursivo: mapas degenerados com milhões de salas
+   não estouram a pilha.
+   ============================================================ */
+typedef struct NoCadeia {
+    uint32_t profundidade;      // SEM_INDICE = inalcançável a partir da raiz
+    uint32_t cabeca;            // sala no topo da cadeia pesada
+    uint32_t profCabeca;        // profundidade da cabeça
+    uint32_t acima;             // pai da cabeça (SEM_INDICE na cadeia da raiz)
+} NoCadeia;
+
+typedef struct IndiceSalas {
+    uint32_t  numSalas, raiz;
+    uint32_t* pai;              // SEM_INDICE na raiz e em salas inalcançáveis
+    NoCadeia* cadeia;
+    uint32_t* nome;             // id do nome no pool
+    uint64_t* direita;          // bit i ligado: sala i é filha direita
+    uint32_t* salaDoTexto;      // id do nome -> sala (a mais rasa, se repetido)
+    size_t    capTextos;
+} IndiceSalas;
+
+/* ------------------------------------------------------------
+ * montarIndiceSalas() – recebe os filhos de cada sala (SEM_INDICE
+ * = nenhum) e os ids dos nomes; o índice fica com 'nome'.
+ * Retorna 0, ou -1 se as ligações não formam uma árvore.
+ * ------------------------------------------------------------ */
+static int montarIndiceSalas(IndiceSalas* ix, uint32_t n, uint32_t raiz,
+                             const uint32_t* esq, const uint32_t* dir, uint32_t* nome) {
+    memset(ix, 0, sizeof(*ix));
+    ix->numSalas = n;
+    ix->raiz = raiz;
+    ix->nome = nome;
+    ix->pai = (uint32_t*) malloc(n * sizeof(uint32_t));
+    ix->cadeia = (NoCadeia*) malloc(n * sizeof(NoCadeia));
+    ix->direita = (uint64_t*) calloc((n + 63) / 64, sizeof(uint64_t));
+    uint32_t* ordem = (uint32_t*) malloc(n * sizeof(uint32_t));   // salas em largura
+    uint32_t* tamanho = (uint32_t*) malloc(n * sizeof(uint32_t)); // tamanho da subárvore
+    if (!ix->pai || !ix->cadeia || !ix->direita || !ordem || !tamanho) {
+        fprintf(stderr, "Falha ao alocar índice de salas.\n");
+        exit(1);
+    }
+    memset(ix->pai, 0xFF, n * sizeof(uint32_t));
+    memset(ix->cadeia, 0xFF, n * sizeof(NoCadeia));
+
+    // 1) largura: pai, profundidade e lado; uma sala vista duas vezes
+    //    (ciclo ou filha compartilhada) invalida o mapa
+    uint32_t ini = 0, fim = 0;
+    ordem[fim++] = raiz;
+    ix->cadeia[raiz].profundidade = 0;
+    while (ini < fim) {
+        uint32_t s = ordem[ini++];
+        for (int lado = 0; lado < 2; ++lado) {
+            uint32_t f = lado ? dir[s] : esq[s];
+            if (f == SEM_INDICE) continue;
+            if (ix->cadeia[f].profundidade != SEM_INDICE) { free(ordem); free(tamanho); return -1; }
+            ix->pai[f] = s;
+            ix->cadeia[f].profundidade = ix->cadeia[s].profundidade + 1;
+            if (lado) ix->direita[f / 64] |= 1ull << (f % 64);
+            ordem[fim++] = f;
+        }
+    }
+
+    // 2) tamanhos das subárvores, de baixo para cima
+    for (uint32_t k = fim; k-- > 0; ) {
+        uint32_t s = ordem[k];
+        tamanho[s] = 1 + (esq[s] != SEM_INDICE ? tamanho[esq[s]] : 0)
+                       + (dir[s] != SEM_INDICE ? tamanho[dir[s]] : 0);
+    }
+
+    // 3) cadeias: a filha maior herda a cabeça da mãe
+    NoCadeia* nc = ix->cadeia;
+    nc[raiz].cabeca = raiz;
+    nc[raiz].profCabeca = 0;
+    nc[raiz].acima = SEM_INDICE;
+    for (uint32_t k = 0; k < fim; ++k) {
+        uint32_t s = ordem[k], e = esq[s], d = dir[s];
+        uint32_t pesada = (d != SEM_INDICE && (e == SEM_INDICE || tamanho[d] > tamanho[e])) ? d : e;
+        for (int lado = 0; lado < 2; ++lado) {
+            uint32_t f = lado ? d : e;
+            if (f == SEM_INDICE) continue;
+            if (f == pesada) {
+                nc[f].cabeca = nc[s].cabeca;
+                nc[f].profCabeca = nc[s].profCabeca;
+                nc[f].acima = nc[s].acima;
+            } else {
+                nc[f].cabeca = f;
+                nc[f].profCabeca = nc[f].profundidade;
+                nc[f].acima = s;
+            }
+        }
+    }
+
+    // 4) nome -> sala; a ordem em largura faz a mais rasa ganhar
+    ix->capTextos = numTextos();
+    ix->salaDoTexto = (uint32_t*) malloc((ix->capTextos ? ix->capTextos : 1) * sizeof(uint32_t));
+    if (!ix->salaDoTexto) { fprintf(stderr, "Falha ao alocar índice de salas.\n"); exit(1); }
+    memset(ix->salaDoTexto, 0xFF, ix->capTextos * sizeof(uint32_t));
+    for (uint32_t k = 0; k < fim; ++k) {
+        uint32_t s = ordem[k];
+        if (nome[s] < ix->capTextos && ix->salaDoTexto[nome[s]] == SEM_INDICE) ix->salaDoTexto[nome[s]] = s;
+    }
+    free(ordem);
+    free(tamanho);
+    return 0;
+}
+
+void liberarIndiceSalas(IndiceSalas* ix) {
+    free(ix->pai);
+    free(ix->cadeia);
+    free(ix->nome);
+    free(ix->direita);
+    free(ix->salaDoTexto);
+    memset(ix, 0, sizeof(*ix));
+}
+
+/* indexarMansao() – índice da mansão em ponteiros (sala i = i-ésima em largura) */
+int indexarMansao(IndiceSalas* ix, Sala* raiz) {
+    uint32_t n = (uint32_t) contarSalas(raiz);
+    if (!n) { memset(ix, 0, sizeof(*ix)); return -1; }
+    Sala** fila = (Sala**) malloc(n * sizeof(Sala*));
+    uint32_t* esq = (uint32_t*) malloc(n * sizeof(uint32_t));
+    uint32_t* dir = (uint32_t*) malloc(n * sizeof(uint32_t));
+    uint32_t* nome = (uint32_t*) malloc(n * sizeof(uint32_t));
+    if (!fila || !esq || !dir || !nome) { fprintf(stderr, "Falha ao alocar índice de salas.\n"); exit(1); }
+    uint32_t ini = 0, fim = 0;
+    fila[fim++] = raiz;
+    while (ini < fim) {
+        Sala* s = fila[ini];
+        nome[ini] = s->nome;
+        esq[ini] = s->esquerda ? fim : SEM_INDICE;
+        if (s->esquerda) fila[fim++] = s->esquerda;
+        dir[ini] = s->direita ? fim : SEM_INDICE;
+        if (s->direita) fila[fim++] = s->direita;
+        ini++;
+    }
+    int rc = montarIndiceSalas(ix, n, 0, esq, dir, nome);
+    free(fila);
+    free(esq);
+    free(dir);
+    if (rc != 0) liberarIndiceSalas(ix);
+    return rc;
+}
+
+/* ------------------------------------------------------------
+ * indexarCenario() – índice de um cenário mapeado (os nomes são
+ * internados aqui). Retorna 0, ou -1 se o cenário não é árvore.
+ * ------------------------------------------------------------ */
+int indexarCenario(IndiceSalas* ix, const Cenario* c) {
+    uint32_t n = c->cab->numSalas;
+    uint32_t* esq = (uint32_t*) malloc(n * sizeof(uint32_t));
+    uint32_t* dir = (uint32_t*) malloc(n * sizeof(uint32_t));
+    uint32_t* nome = (uint32_t*) malloc(n * sizeof(uint32_t));
+    if (!esq || !dir || !nome) { fprintf(stderr, "Falha ao alocar índice de salas.\n"); exit(1); }
+    for (uint32_t i = 0; i < n; ++i) {
+        esq[i] = filhoCenario(c, i, 'e');
+        dir[i] = filhoCenario(c, i, 'd');
+        nome[i] = internarStr(nomeSalaCenario(c, i));
+    }
+    int rc = montarIndiceSalas(ix, n, c->cab->raiz, esq, dir, nome);
+    free(esq);
+    free(dir);
+    if (rc != 0) liberarIndiceSalas(ix);
+    return rc;
+}
+
+/* salaPorNome() – índice da sala com esse nome (ou SEM_INDICE) */
+uint32_t salaPorNome(const IndiceSalas* ix, const char* nome) {
+    uint32_t id = buscarStr(nome);
+    return id < ix->capTextos ? ix->salaDoTexto[id] : SEM_INDICE;
+}
+
+/* ------------------------------------------------------------
+ * caminhoAteSala() – escreve em 'buf' os movimentos 'e'/'d' da
+ * raiz até a sala e devolve quantos são (SEM_INDICE se a sala é
+ * inalcançável). Com 'cap' pequeno demais só devolve o tamanho.
+ * ------------------------------------------------------------ */
+uint32_t caminhoAteSala(const IndiceSalas* ix, uint32_t sala, char* buf, size_t cap) {
+    if (sala >= ix->numSalas || ix->cadeia[sala].profundidade == SEM_INDICE) return SEM_INDICE;
+    uint32_t d = ix->cadeia[sala].profundidade;
+    if ((size_t) d + 1 > cap) return d;
+    buf[d] = '\0';
+    for (uint32_t s = sala, k = d; k-- > 0; s = ix->pai[s])
+        buf[k] = (ix->direita[s / 64] >> (s % 64)) & 1 ? 'd' : 'e';
+    return d;
+}
+
+/* ancestralComum() – sala mais funda acima das duas (ou SEM_INDICE) */
+uint32_t ancestralComum(const IndiceSalas* ix, uint32_t a, uint32_t b) {
+    if (a >= ix->numSalas || b >= ix->numSalas
+        || ix->cadeia[a].profundidade == SEM_INDICE || ix->cadeia[b].profundidade == SEM_INDICE) return SEM_INDICE;
+    NoCadeia na = ix->cadeia[a], nb = ix->cadeia[b];
+    while (na.cabeca != nb.cabeca) {
+        // sobe quem está na cadeia de cabeça mais funda
+        if (na.profCabeca > nb.profCabeca) { a = na.acima; na = ix->cadeia[a]; }
+        else                               { b = nb.acima; nb = ix->cadeia[b]; }
+    }
+    return na.profundidade < nb.profundidade ? a : b;
+}
+
+/* distanciaSalas() – número de passagens entre duas salas */
+uint32_t distanciaSalas(const IndiceSalas* ix, uint32_t a, uint32_t b) {
+    uint32_t c = ancestralComum(ix, a, b);
+    if (c == SEM_INDICE) return SEM_INDICE;
+    return ix->cadeia[a].profundidade + ix->cadeia[b].profundidade - 2 * ix->cadeia[c].profundidade;
+}
+
+/* ------------------------------------------------------------
+ * consultarSalas() – responde --caminho (só 'destino') ou
+ * --distancia ('origem' e 'destino'). Retorna 0 ou -1.
+ * ------------------------------------------------------------ */
+int consultarSalas(FILE* out, const IndiceSalas* ix, const char* origem, const char* destino) {
+    uint32_t a = origem ? salaPorNome(ix, origem) : ix->raiz;
+    uint32_t b = salaPorNome(ix, destino);
+    if (a == SEM_INDICE || b == SEM_INDICE) {
+        fprintf(stderr, "Sala '%s' não encontrada.\n", a == SEM_INDICE ? origem : destino);
+        return -1;
+    }
+    if (!origem) {
+        uint32_t d = caminhoAteSala(ix, b, NULL, 0);
+        char* buf = (char*) malloc((size_t) d + 1);
+        if (!buf) { fprintf(stderr, "Falha ao alocar caminho.\n"); exit(1); }
+        caminhoAteSala(ix, b, buf, (size_t) d + 1);
+        fprintf(out, "%s\t%u\t%s\n", destino, d, buf);
+        free(buf);
+        return 0;
+    }
+    uint32_t c = ancestralComum(ix, a, b);
+    fprintf(out, "%s\t%s\t%u\t%s\n", origem, destino, distanciaSalas(ix, a, b), textoDoId(ix->nome[c]));
+    return 0;
+}
+
+/* ============================================================
+   Interface / Fluxo do jogo
+   ============================================================ */
+
+void limparEntrada() {
+    int c; while ((c = getchar()) != '\n' && c != EOF) {}
+}
+
+/* ------------------------------------------------------------
+ * perguntarBusca() – opção (b) da exploração: lê um trecho (ou
+ * "^início") e lista as pistas coletadas que o contêm
+ * ------------------------------------------------------------ */
+#define BUSCA_MAX_RESULTADOS 20
+
+static void perguntarBusca(Saida* so, Sessao* sessao) {
+    char consulta[128];
+    limparEntrada(); // resto da linha da opção
+    escrever(so, "Buscar (trecho, ou ^início): ");
+    descarregar(so);
+    if (!fgets(consulta, sizeof(consulta), stdin)) return;
+    size_t len = strlen(consulta);
+    if (len && consulta[len-1] == '\n') consulta[--len] = '\0';
+
+    const char* achadas[BUSCA_MAX_RESULTADOS];
+    size_t n = buscarNaSessao(sessao, consulta, achadas, BUSCA_MAX_RESULTADOS);
+    if (!n) escrever(so, "Nenhuma pista coletada corresponde.\n");
+    for (size_t i = 0; i < n; ++i) escreverPista(so, achadas[i]);
+    if (n == BUSCA_MAX_RESULTADOS) escrever(so, "(mostrando só as primeiras %d)\n", BUSCA_MAX_RESULTADOS);
+}
+
+/* ------------------------------------------------------------
+ * explorarSalas() – navega pela árvore e ativa o sistema de pistas
+ * - a cada sala visitada: mostra a sala, revela a pista (se houver)
+ *   e insere na BST de pistas coletadas.
+ * - navegação: (e) esquerda, (d) direita, (s) sair e, com
+ *   'podePausar', (g) guardar a sessão para depois; uma opção
+ *   inválida só repete a pergunta (a sala não conta de novo)
+ * Retorna a sala onde o jogador pausou (NULL se saiu).
+ * ------------------------------------------------------------ */
+Sala* explorarSalas(Sala* inicio, HashTable* ht, Sessao* sessao, int podePausar) {
+    Saida* so = saidaPadrao();
+    Sala* atual = inicio;
+    char op;
+
+    while (atual) {
+        sessao->salasVisitadas++;
+        RASTRO(RASTRO_SALA, sessaoRastro(sessao), atual->nome, 0);
+        escrever(so, "\nVocê está em: %s\n", nomeSala(atual));
+
+        const char* pista = textoPista(atual->pista);
+        if (*pista) {
+            escrever(so, "Pista encontrada: %s\n", pista);
+            coletarPistaId(sessao, ht, idTextoPista(atual->pista));
+        } else {
+            escrever(so, "Nenhuma pista aqui.\n");
+        }
+
+        escrever(so, "\nEscolha um caminho:\n");
+        if (atual->esquerda) escrever(so, " (e) Esquerda -> %s\n", nomeSala(atual->esquerda));
+        if (atual->direita)  escrever(so, " (d) Direita  -> %s\n", nomeSala(atual->direita));
+        escrever(so, " (s) Sair da exploração\n");
+        if (podePausar) escrever(so, " (g) Guardar a sessão e continuar depois\n");
+        escrever(so, " (b) Buscar nas pistas coletadas\n");
+        for (;;) {
+            escrever(so, "Sua escolha: ");
+            descarregar(so);    // uma escrita por sala, antes de esperar o jogador
+            if (scanf(" %c", &op) != 1) { escrever(so, "Entrada inválida.\n"); descarregar(so); return NULL; }
+            if (op == 'b') { perguntarBusca(so, sessao); continue; }
+            if ((op == 'e' && atual->esquerda) || (op == 'd' && atual->direita) ||
+                op == 's' || (op == 'g' && podePausar)) break;
+            // opção inválida: pergunta de novo sem reentrar na sala
+            escrever(so, "Opção inválida, tente novamente.\n");
+        }
+
+        if (op == 'e') {
+            atual = atual->esquerda;
+        } else if (op == 'd') {
+            atual = atual->direita;
+        } else if (op == 's') {
+            escrever(so, "\nExploração encerrada pelo jogador.\n");
+            break;
+        } else {
+            return atual;
+        }
+    }
+    return NULL;
+}
+
+/* ------------------------------------------------------------
+ * explorarCenario() – mesma navegação de explorarSalas(), mas
+ * sobre um cenário mapeado. A associação pista -> suspeito é
+ * levada à hash só quando a pista é coletada, então a abertura
+ * não depende do tamanho do cenário. Começa na sala 'inicio' e
+ * retorna o índice da sala onde o jogador pausou (ou SEM_INDICE).
+ * ------------------------------------------------------------ */
+uint32_t explorarCenario(const Cenario* c, uint32_t inicio, HashTable* ht, Sessao* sessao, int podePausar) {
+    Saida* so = saidaPadrao();
+    uint32_t atual = inicio < c->cab->numSalas ? inicio : c->cab->raiz;
+    char op;
+
+    while (atual != SEM_INDICE) {
+        sessao->salasVisitadas++;
+        RASTRO(RASTRO_SALA_CENARIO, sessaoRastro(sessao), atual, 0);
+        escrever(so, "\nVocê está em: %s\n", nomeSalaCenario(c, atual));
+
+        const char* pista = pistaSalaCenario(c, atual);
+        if (*pista) {
+            escrever(so, "Pista encontrada: %s\n", pista);
+            associarPistaCenario(ht, c, c->salas[atual].pista);
+            coletarPista(sessao, ht, pista);
+        } else {
+            escrever(so, "Nenhuma pista aqui.\n");
+        }
+
+        uint32_t esq = filhoCenario(c, atual, 'e');
+        uint32_t dir = filhoCenario(c, atual, 'd');
+        escrever(so, "\nEscolha um caminho:\n");
+        if (esq != SEM_INDICE) escrever(so, " (e) Esquerda -> %s\n", nomeSalaCenario(c, esq));
+        if (dir != SEM_INDICE) escrever(so, " (d) Direita  -> %s\n", nomeSalaCenario(c, dir));
+        escrever(so, " (s) Sair da exploração\n");
+        if (podePausar) escrever(so, " (g) Guardar a sessão e continuar depois\n");
+        escrever(so, " (b) Buscar nas pistas coletadas\n");
+        for (;;) {
+            escrever(so, "Sua escolha: ");
+            descarregar(so);    // uma escrita por sala, antes de esperar o jogador
+            if (scanf(" %c", &op) != 1) { escrever(so, "Entrada inválida.\n"); descarregar(so); return SEM_INDICE; }
+            if (op == 'b') { perguntarBusca(so, sessao); continue; }
+            if ((op == 'e' && esq != SEM_INDICE) || (op == 'd' && dir != SEM_INDICE) ||
+                op == 's' || (op == 'g' && podePausar)) break;
+            // opção inválida: pergunta de novo sem reentrar na sala
+            escrever(so, "Opção inválida, tente novamente.\n");
+        }
+
+        if (op == 'e') {
+            atual = esq;
+        } else if (op == 'd') {
+            atual = dir;
+        } else if (op == 's') {
+            escrever(so, "\nExploração encerrada pelo jogador.\n");
+            break;
+        } else {
+            return atual;
+        }
+    }
+    return SEM_INDICE;
+}
+
+/* ------------------------------------------------------------
+ * listarSuspeitos() – imprime os suspeitos do cenário carregado
+ * (ou os da mansão padrão), limitando listas muito longas.
+ * ------------------------------------------------------------ */
+static void listarSuspeitos(Saida* so, const Cenario* c) {
+    if (!c) {
+        escrever(so, "\nSuspeitos possíveis: Mordomo, Cozinheira, Jardineiro, Bibliotecária\n");
+        return;
+    }
+    const uint32_t limite = 20;
+    uint32_t n = c->cab->numSuspeitos;
+    escrever(so, "\nSuspeitos possíveis: ");
+    for (uint32_t i = 0; i < n && i < limite; ++i) {
+        escrever(so, "%s%s", i ? ", " : "", stringCenario(c, c->suspeitos[i].nome));
+    }
+    if (n > limite) escrever(so, " ... (+%u)", n - limite);
+    escrever(so, "\n");
+}
+
+/* ------------------------------------------------------------
+ * verificarSuspeitoFinal() – julgamento final:
+ * - lista pistas coletadas
+ * - pede acusação
+ * - verifica se ≥ 2 pistas apontam para o acusado
+ * ------------------------------------------------------------ */
+void verificarSuspeitoFinal(Sessao* sessao, HashTable* ht, const Cenario* cenario) {
+    Saida* so = saidaPadrao();
+    escrever(so, "\n==============================\n");
+    escrever(so, "Pistas coletadas (ordem A-Z):\n");
+    escrever(so, "==============================\n");
+    if (!sessao->numPistas) {
+        escrever(so, "(nenhuma pista coletada)\n");
+    } else {
+        CursorPistas cur;
+        const char* p;
+        cursorSessao(&cur, sessao);
+        while ((p = cursorProxima(&cur)) != NULL) {
+            if (!so->compacto) escreverPista(so, p);
+            else escrever(so, "%s\t%s\n", p, cur.ultimaCongelada != SEM_INDICE
+                                              ? suspeitoDaCongelada(sessao, ht, cur.ultimaCongelada)
+                                              : encontrarSuspeito(ht, p));
+        }
+    }
+
+    uint32_t top[3];
+    uint32_t nTop = suspeitosMaisCitados(sessao, 3, top);
+    if (nTop) {
+        escrever(so, "\nSuspeitos mais citados: ");
+        for (uint32_t i = 0; i < nTop; ++i)
+            escrever(so, "%s%s (%u)", i ? ", " : "", nomeSuspeito(ht, top[i]), sessao->votos[top[i]]);
+        escrever(so, "\n");
+    }
+
+    listarSuspeitos(so, cenario);
+    escrever(so, "Quem você acusa? ");
+    descarregar(so);
+    limparEntrada(); // limpa \n deixado por scanf anterior
+    char acusado[64];
+    if (!fgets(acusado, sizeof(acusado), stdin)) {
+        escrever(so, "Não foi possível ler a acusação.\n");
+        descarregar(so);
+        return;
+    }
+    // remove \n
+    size_t len = strlen(acusado);
+    if (len && acusado[len-1] == '\n') acusado[len-1] = '\0';
+
+    // soma dos pesos; com as associações padrão (peso 1) = nº de pistas
+    uint32_t peso = votosPara(sessao, ht, acusado);
+    rastrearJulgamento(sessao, ht, acusado, peso);
+
+    escrever(so, "\nResultado do julgamento:\n");
+    if (peso >= PESO_SUSTENTA) {
+        escrever(so, "Acusação de \"%s\" SUSTENTADA com peso %u das pistas. Caso encerrado!\n", acusado, peso);
+    } else {
+        escrever(so, "Acusação de \"%s\" NÃO sustentada (peso das pistas: apenas %u de %u). Investigue mais!\n",
+                 acusado, peso, PESO_SUSTENTA);
+    }
+    descarregar(so);
+}
+
+/* ============================================================
+   Modo roteiro (sem interação)
+   Cada linha da entrada é uma sessão: uma sequência de movimentos
+   e/d/s seguida do nome do acusado, por exemplo
+       eds Jardineiro
+   Linhas vazias ou iniciadas por '#' são ignoradas. A entrada é
+   lida de uma vez, a narrativa é suprimida e cada sessão gera uma
+   linha separada por tabulações (via Saida bufferizada):
+       sessão  sala_final  pistas  acusado  peso  veredito
+   ('peso' é a soma dos pesos das pistas contra o acusado; ver
+   votosPara())
+   ============================================================ */
+
+/* ------------------------------------------------------------
+ * jogarRoteiro() / jogarRoteiroCenario() – aplicam os movimentos
+ * com as mesmas regras de explorarSalas(): coleta a pista de cada
+ * sala visitada, ignora movimentos inválidos e para em 's'.
+ * Retornam o nome da sala onde a exploração terminou.
+ * ------------------------------------------------------------ */
+const char* jogarRoteiro(Sala* inicio, HashTable* ht, Sessao* sessao, const char* movs, size_t n) {
+    Sala* atual = inicio;
+    size_t i = 0;
+    for (;;) {
+        sessao->salasVisitadas++;
+        RASTRO(RASTRO_SALA, sessaoRastro(sessao), atual->nome, 0);
+        if (atual->pista != SEM_PISTA) coletarPistaId(sessao, ht, idTextoPista(atual->pista));
+        // movimentos inválidos não mudam de sala (e a pista já foi coletada)
+        while (i < n && !((movs[i] == 'e' && atual->esquerda) ||
+                          (movs[i] == 'd' && atual->direita) || movs[i] == 's')) i++;
+        if (i == n || movs[i] == 's') return nomeSala(atual);
+        atual = (movs[i++] == 'e') ? atual->esquerda : atual->direita;
+    }
+}
+
+const char* jogarRoteiroCenario(const Cenario* c, HashTable* ht, Sessao* sessao, const char* movs, size_t n) {
+    uint32_t atual = c->cab->raiz;
+    size_t i = 0;
+    for (;;) {
+        sessao->salasVisitadas++;
+        RASTRO(RASTRO_SALA_CENARIO, sessaoRastro(sessao), atual, 0);
+        const char* pista = pistaSalaCenario(c, atual);
+        if (*pista) {
+            associarPistaCenario(ht, c, c->salas[atual].pista);
+            coletarPista(sessao, ht, pista);
+        }
+        uint32_t prox = SEM_INDICE;
+        while (i < n && movs[i] != 's' && (prox = filhoCenario(c, atual, movs[i])) == SEM_INDICE) i++;
+        if (i == n || movs[i] == 's') return nomeSalaCenario(c, atual);
+        atual = prox;
+        i++;
+    }
+}
+
+/* ------------------------------------------------------------
+ * lerTudo() – lê um arquivo inteiro (ou stdin, com "-") em blocos
+ * grandes; devolve buffer terminado em '\0' (liberar com free)
+ * ------------------------------------------------------------ */
+static char* lerTudo(const char* caminho, size_t* tam) {
+    FILE* f = strcmp(caminho, "-") == 0 ? stdin : fopen(caminho, "rb");
+    if (!f) { fprintf(stderr, "Não foi possível abrir '%s'.\n", caminho); return NULL; }
+    size_t cap = 1 << 16, n = 0, lidos;
+    char* buf = (char*) malloc(cap);
+    if (!buf) { fprintf(stderr, "Falha ao alocar buffer de leitura.\n"); exit(1); }
+    while ((lidos = fread(buf + n, 1, cap - n - 1, f)) > 0) {
+        n += lidos;
+        if (cap - n - 1 == 0) {
+            char* novo = (char*) realloc(buf, cap * 2);
+            if (!novo) { fprintf(stderr, "Falha ao alocar buffer de leitura.\n"); exit(1); }
+            buf = novo;
+            cap *= 2;
+        }
+    }
+    if (f != stdin) fclose(f);
+    buf[n] = '\0';
+    *tam = n;
+    return buf;
+}
+
+/* ------------------------------------------------------------
+ * carregarArquivoAssociacoes() – lê relações extras, uma por
+ * linha: "pista<TAB>suspeito[<TAB>peso]" (peso padrão 1, 0 desfaz
+ * a relação; linhas vazias e com '#' são ignoradas). Retorna
+ * quantas relações aplicou ou -1 em caso de erro.
+ * ------------------------------------------------------------ */
+long carregarArquivoAssociacoes(HashTable* ht, const char* caminho) {
+    size_t tam;
+    char* texto = lerTudo(caminho, &tam);
+    if (!texto) return -1;
+
+    long aplicadas = 0, numLinha = 0;
+    char* p = texto;
+    char* fimTexto = texto + tam;
+    while (p < fimTexto) {
+        char* fimLinha = memchr(p, '\n', (size_t) (fimTexto - p));
+        if (!fimLinha) fimLinha = fimTexto;
+        char* linha = p;
+        p = fimLinha + 1;
+        numLinha++;
+        if (fimLinha > linha && fimLinha[-1] == '\r') fimLinha--;
+        *fimLinha = '\0';
+        if (linha == fimLinha || *linha == '#') continue;
+
+        char* suspeito = strchr(linha, '\t');
+        char* peso = suspeito ? strchr(suspeito + 1, '\t') : NULL;
+        if (suspeito) *suspeito++ = '\0';
+        if (peso) *peso++ = '\0';
+        char* fim = NULL;
+        unsigned long valor = peso ? strtoul(peso, &fim, 10) : 1;
+        if (!suspeito || !*linha || !*suspeito || (peso && (fim == peso || *fim || valor > PESO_MAX))) {
+            fprintf(stderr, "%s:%ld: esperado pista<TAB>suspeito[<TAB>peso 0..%u].\n",
+                    caminho, numLinha, PESO_MAX);
+            free(texto);
+            return -1;
+        }
+        associarPista(ht, linha, suspeito, (uint32_t) valor);
+        aplicadas++;
+    }
+    free(texto);
+    return aplicadas;
+}
+
+/* ------------------------------------------------------------
+ * executarRoteiros() – roda todas as sessões do roteiro,
+ * reaproveitando a mesma sessão (um reset de arena entre elas).
+ * Retorna o número de sessões ou -1 se o arquivo não abriu.
+ * ------------------------------------------------------------ */
+long executarRoteiros(const char* caminho, Sala* inicio, const Cenario* c, HashTable* ht, Saida* out) {
+    size_t tam;
+    char* texto = lerTudo(caminho, &tam);
+    if (!texto) return -1;
+
+    Sessao sessao;
+    iniciarSessao(&sessao);
+    long numSessoes = 0;
+    char* p = texto;
+    char* fimTexto = texto + tam;
+    while (p < fimTexto) {
+        char* fimLinha = memchr(p, '\n', (size_t) (fimTexto - p));
+        if (!fimLinha) fimLinha = fimTexto;
+        char* linha = p;
+        p = fimLinha + 1;
+
+        while (linha < fimLinha && isspace((unsigned char) *linha)) linha++;
+        if (linha == fimLinha || *linha == '#') continue;
+        char* movs = linha;
+        while (linha < fimLinha && !isspace((unsigned char) *linha)) linha++;
+        size_t numMovs = (size_t) (linha - movs);
+        while (linha < fimLinha && isspace((unsigned char) *linha)) linha++;
+        char* acusado = linha;
+        char* fimAcusado = fimLinha;
+        while (fimAcusado > acusado && isspace((unsigned char) fimAcusado[-1])) fimAcusado--;
+        *fimAcusado = '\0';
+
+        reiniciarSessao(&sessao);
+        const char* salaFinal = c ? jogarRoteiroCenario(c, ht, &sessao, movs, numMovs)
+                                  : jogarRoteiro(inicio, ht, &sessao, movs, numMovs);
+        uint32_t votos = votosPara(&sessao, ht, acusado);
+        rastrearJulgamento(&sessao, ht, acusado, votos);
+        escrever(out, "%ld\t%s\t%zu\t%s\t%u\t%s\n", ++numSessoes, salaFinal, sessao.numPistas,
+                acusado, votos, votos >= PESO_SUSTENTA ? "SUSTENTADA" : "NAO_SUSTENTADA");
+    }
+    descarregar(out);
+    liberarSessao(&sessao);
+    free(texto);
+    return numSessoes;
+}
+
+/* ============================================================
+   ESTRUTURA 8: Mapa compacto (salas num vetor, ordem van Emde Boas)
+   Para as cargas que só andam pelo mapa (simulador, rotas), as
+   salas alcançáveis da raiz viram um vetor imutável de registros
+   de 16 bytes – filhos e pai como posições de 32 bits, pista como
+   id do texto no pool –, 4 salas por linha de cache. Nomes e o
+   índice de origem ficam num vetor à parte, frio.
+   A ordem é a de van Emde Boas: a subárvore de altura h é cortada
+   na metade da altura; o topo é disposto primeiro e cada subárvore
+   de baixo em seguida, recursivamente. Qualquer caminho raiz ->
+   folha de comprimento L toca O(L / log B) blocos de B salas, em
+   vez de um acesso fora de cache por passo na árvore de ponteiros.
+   Num mapa que não é árvore (sala com dois pais, ciclo), a ordem
+   segue a árvore da busca em largura e as ligações extras são
+   mantidas; 'arvore' fica 0.
+   ============================================================ */
+typedef enum { MAPA_LARGURA, MAPA_VEB } OrdemMapa;
+
+typedef struct SalaCompacta {
+    uint32_t esq, dir;          // posições dos filhos (SEM_INDICE = sem saída)
+    uint32_t pista;             // id do texto da pista no pool (SEM_INDICE = nenhuma)
+    uint32_t pai;               // posição do pai na árvore da largura (SEM_INDICE na raiz)
+} SalaCompacta;
+
+_Static_assert(sizeof(SalaCompacta) == 16, "SalaCompacta deve ter 16 bytes");
+
+typedef struct MapaSalas {
+    SalaCompacta* salas;        // quente; a raiz fica na posição 0
+    uint32_t*     origem;       // frio: índice na fonte (largura na mansão, arquivo no cenário)
+    uint32_t      n;
+    int           arvore;       // 1 = cada sala alcançável tem um só caminho desde a raiz
+} MapaSalas;
+
+/* Estado da montagem; a fonte é a mansão achatada em vetores ou o
+ * cenário (lido direto do mapeamento) */
+typedef struct MontagemMapa {
+    const Cenario* c;
+    uint32_t  n;                // salas na fonte
+    uint32_t* esqFonte;         // só na mansão
+    uint32_t* dirFonte;
+    uint32_t* pai;              // pai na árvore da largura, por índice na fonte
+    uint32_t* altura;           // altura da subárvore, por índice na fonte
+    uint32_t* ordem;            // índices na fonte, na ordem final
+    uint32_t  numOrdem;
+    uint32_t* fronteira;        // raízes de subárvores ainda por dispor (uso em pilha)
+    size_t    numFronteira, capFronteira;
+    uint64_t* pilha;            // (sala << 32) | profundidade, para coletarFronteira()
+    size_t    capPilha;
+} MontagemMapa;
+
+static inline uint32_t filhoFonte(const MontagemMapa* m, uint32_t i, char lado) {
+    if (m->c) return filhoCenario(m->c, i, lado);
+    return lado == 'e' ? m->esqFonte[i] : m->dirFonte[i];
+}
+
+/* filhoNaArvore() – filho só se a sala foi alcançada por este pai */
+static inline uint32_t filhoNaArvore(const MontagemMapa* m, uint32_t i, char lado) {
+    uint32_t f = filhoFonte(m, i, lado);
+    return f != SEM_INDICE && m->pai[f] == i ? f : SEM_INDICE;
+}
+
+static void* crescerVetor(void* v, size_t* cap, size_t tamItem) {
+    *cap = *cap ? *cap * 2 : 256;
+    v = realloc(v, *cap * tamItem);
+    if (!v) { fprintf(stderr, "Falha ao alocar o mapa.\n"); exit(1); }
+    return v;
+}
+
+/* ------------------------------------------------------------
+ * coletarFronteira() – empilha em 'fronteira', da esquerda para
+ * a direita, as salas a 'prof' níveis abaixo de v
+ * ------------------------------------------------------------ */
+static void coletarFronteira(MontagemMapa* m, uint32_t v, uint32_t prof) {
+    size_t topo = 0;
+    if (!m->capPilha) m->pilha = (uint64_t*) crescerVetor(m->pilha, &m->capPilha, sizeof(uint64_t));
+    m->pilha[topo++] = (uint64_t) v << 32;
+    while (topo) {
+        uint64_t item = m->pilha[--topo];
+        uint32_t s = (uint32_t) (item >> 32), d = (uint32_t) item;
+        if (d == prof) {
+            if (m->numFronteira == m->capFronteira)
+                m->fronteira = (uint32_t*) crescerVetor(m->fronteira, &m->capFronteira, sizeof(uint32_t));
+            m->fronteira[m->numFronteira++] = s;
+            continue;
+        }
+        if (topo + 2 > m->capPilha) m->pilha = (uint64_t*) crescerVetor(m->pilha, &m->capPilha, sizeof(uint64_t));
+        uint32_t e = filhoNaArvore(m, s, 'e'), di = filhoNaArvore(m, s, 'd');
+        if (di != SEM_INDICE) m->pilha[topo++] = ((uint64_t) di << 32) | (d + 1);
+        if (e != SEM_INDICE)  m->pilha[topo++] = ((uint64_t) e << 32) | (d + 1);
+    }
+}
+
+/* ------------------------------------------------------------
+ * disporVeb() – os h primeiros níveis da subárvore de v: metade de
+ * cima, depois cada subárvore da metade de baixo. A recursão só
+ * desce O(log h) níveis, mesmo num mapa degenerado.
+ * ------------------------------------------------------------ */
+static void disporVeb(MontagemMapa* m, uint32_t v, uint32_t h) {
+    if (h > m->altura[v]) h = m->altura[v];
+    if (h == 1) { m->ordem[m->numOrdem++] = v; return; }
+    uint32_t topo = h / 2;
+    disporVeb(m, v, topo);
+    size_t base = m->numFronteira;
+    coletarFronteira(m, v, topo);
+    size_t fim = m->numFronteira;
+    for (size_t i = base; i < fim; ++i) disporVeb(m, m->fronteira[i], h - topo);
+    m->numFronteira = base;
+}
+
+/* ------------------------------------------------------------
+ * montarMapa() – mapa compacto da mansão (c == NULL) ou do
+ * cenário, na ordem pedida
+ * ------------------------------------------------------------ */
+void montarMapa(MapaSalas* mapa, Sala* raiz, const Cenario* c, OrdemMapa ordem) {
+    MontagemMapa m;
+    memset(&m, 0, sizeof(m));
+    m.c = c;
+    m.n = c ? c->cab->numSalas : (uint32_t) contarSalas(raiz);
+    uint32_t* pistaFonte = NULL;        // id do texto, só na mansão
+    uint32_t* textoDaPista = NULL;      // id do texto por PistaRec, só no cenário
+    if (c) {
+        textoDaPista = (uint32_t*) malloc((c->cab->numPistas ? c->cab->numPistas : 1) * sizeof(uint32_t));
+        if (!textoDaPista) { fprintf(stderr, "Falha ao alocar o mapa.\n"); exit(1); }
+        for (uint32_t p = 0; p < c->cab->numPistas; ++p) {
+            const char* t = stringCenario(c, c->pistas[p].texto);
+            textoDaPista[p] = *t ? internarStr(t) : SEM_INDICE;
+        }
+    } else {
+        // mansão achatada em largura (o índice é o de indiceDaSala())
+        Sala** fila = (Sala**) malloc(m.n * sizeof(Sala*));
+        m.esqFonte = (uint32_t*) malloc(m.n * sizeof(uint32_t));
+        m.dirFonte = (uint32_t*) malloc(m.n * sizeof(uint32_t));
+        pistaFonte = (uint32_t*) malloc(m.n * sizeof(uint32_t));
+        if (!fila || !m.esqFonte || !m.dirFonte || !pistaFonte) { fprintf(stderr, "Falha ao alocar o mapa.\n"); exit(1); }
+        uint32_t ini = 0, fim = 0;
+        fila[fim++] = raiz;
+        while (ini < fim) {
+            Sala* s = fila[ini];
+            m.esqFonte[ini] = s->esquerda ? fim : SEM_INDICE;
+            if (s->esquerda) fila[fim++] = s->esquerda;
+            m.dirFonte[ini] = s->direita ? fim : SEM_INDICE;
+            if (s->direita) fila[fim++] = s->direita;
+            pistaFonte[ini] = s->pista != SEM_PISTA ? idTextoPista(s->pista) : SEM_INDICE;
+            ini++;
+        }
+        free(fila);
+    }
+    uint32_t raizFonte = c ? c->cab->raiz : 0;
+
+    // 1) largura a partir da raiz: árvore geradora e ordem de visita
+    m.pai = (uint32_t*) malloc(m.n * sizeof(uint32_t));
+    m.altura = (uint32_t*) malloc(m.n * sizeof(uint32_t));
+    m.ordem = (uint32_t*) malloc(m.n * sizeof(uint32_t));
+    if (!m.pai || !m.altura || !m.ordem) { fprintf(stderr, "Falha ao alocar o mapa.\n"); exit(1); }
+    memset(m.pai, 0xFF, m.n * sizeof(uint32_t));
+    int arvore = 1;
+    uint32_t alcancadas = 0;
+    m.ordem[alcancadas++] = raizFonte;
+    m.pai[raizFonte] = raizFonte;       // marca de visitada; volta a SEM_INDICE no fim
+    for (uint32_t k = 0; k < alcancadas; ++k) {
+        uint32_t s = m.ordem[k];
+        for (int lado = 0; lado < 2; ++lado) {
+            uint32_t f = filhoFonte(&m, s, lado ? 'd' : 'e');
+            if (f == SEM_INDICE) continue;
+            if (m.pai[f] != SEM_INDICE) { arvore = 0; continue; }
+            m.pai[f] = s;
+            m.ordem[alcancadas++] = f;
+        }
+    }
+    m.pai[raizFonte] = SEM_INDICE;
+
+    // 2) alturas, das folhas para cima (largura ao contrário)
+    if (ordem == MAPA_VEB) {
+        for (uint32_t k = alcancadas; k-- > 0;) {
+            uint32_t s = m.ordem[k], e = filhoNaArvore(&m, s, 'e'), d = filhoNaArvore(&m, s, 'd');
+            uint32_t h = 0;
+            if (e != SEM_INDICE) h = m.altura[e];
+            if (d != SEM_INDICE && m.altura[d] > h) h = m.altura[d];
+            m.altura[s] = h + 1;
+        }
+        m.numOrdem = 0;
+        disporVeb(&m, raizFonte, m.altura[raizFonte]);
+    }
+
+    // 3) vetor final: posição de cada sala da fonte (reusa 'altura')
+    uint32_t* posicao = m.altura;
+    memset(posicao, 0xFF, m.n * sizeof(uint32_t));
+    for (uint32_t k = 0; k < alcancadas; ++k) posicao[m.ordem[k]] = k;
+    mapa->n = alcancadas;
+    mapa->arvore = arvore;
+    mapa->salas = (SalaCompacta*) aligned_alloc(64, ((alcancadas * sizeof(SalaCompacta) + 63) / 64) * 64);
+    mapa->origem = (uint32_t*) malloc(alcancadas * sizeof(uint32_t));
+    if (!mapa->salas || !mapa->origem) { fprintf(stderr, "Falha ao alocar o mapa.\n"); exit(1); }
+    for (uint32_t k = 0; k < alcancadas; ++k) {
+        uint32_t s = m.ordem[k], e = filhoFonte(&m, s, 'e'), d = filhoFonte(&m, s, 'd');
+        SalaCompacta* sc = &mapa->salas[k];
+        sc->esq = e != SEM_INDICE ? posicao[e] : SEM_INDICE;
+        sc->dir = d != SEM_INDICE ? posicao[d] : SEM_INDICE;
+        sc->pai = m.pai[s] != SEM_INDICE ? posicao[m.pai[s]] : SEM_INDICE;
+        if (c) {
+            uint32_t p = c->salas[s].pista;
+            sc->pista = p < c->cab->numPistas ? textoDaPista[p] : SEM_INDICE;
+        } else {
+            sc->pista = pistaFonte[s];
+        }
+        mapa->origem[k] = s;
+    }
+
+    free(textoDaPista);
+    free(pistaFonte);
+    free(m.esqFonte);
+    free(m.dirFonte);
+    free(m.pai);
+    free(m.altura);
+    free(m.ordem);
+    free(m.fronteira);
+    free(m.pilha);
+}
+
+void liberarMapa(MapaSalas* mapa) {
+    free(mapa->salas);
+    free(mapa->origem);
+    memset(mapa, 0, sizeof(*mapa));
+}
+
+/* ============================================================
+   Simulador Monte Carlo (várias threads)
+   Roda muitas sessões de caminhada aleatória a partir do Hall e
+   conta, para cada suspeito, em quantas sessões as pistas
+   coletadas sustentariam a acusação (regra do julgamento final:
+   pelo menos 2 pistas). Mapa e hash são só lidos pelas threads;
+   cada thread tem sua própria Sessao e seus próprios contadores,
+   somados no final (nada de trava no caminho quente).
+
+   Balanceamento por roubo de trabalho: as sessões são divididas
+   em lotes; cada thread começa com uma faixa contígua de lotes,
+   consome pela frente e, quando esvazia, rouba metade do que
+   resta no fim da faixa de outra thread. Início e fim da faixa
+   ficam num único atômico de 64 bits, alterado só por CAS.
+   ============================================================ */
+#define SIM_LOTE       1024u    // sessões por lote
+#define SIM_PARADA     10u      // chance (%) de o jogador sair em cada sala
+#define SIM_ALINHAMENTO 64
+
+typedef struct Simulacao {
+    const MapaSalas* mapa;      // mansão ou cenário, em vetor (ESTRUTURA 8)
+    HashTable*      ht;         // somente leitura durante a simulação
+    uint64_t        numSessoes;
+    uint32_t        maxPassos;
+    uint64_t        semente;
+} Simulacao;
+
+typedef struct TrabalhadorSim {
+    _Alignas(SIM_ALINHAMENTO) _Atomic uint64_t faixa;  // (inicio << 32) | fim, em lotes
+    const Simulacao* sim;
+    struct TrabalhadorSim* todos;
+    uint32_t id, numTrabalhadores;
+    // resultados locais
+    uint64_t* condenacoes;      // por suspeito
+    uint64_t  semCondenacao, salasVisitadas, pistasColetadas, sessoes;
+    pthread_t thread;
+} TrabalhadorSim;
+
+/* splitmix64: gerador pequeno e rápido; cada sessão tem seu
+ * próprio fluxo, então o resultado não depende das threads */
+static inline uint64_t proximoAleatorio(uint64_t* estado) {
+    uint64_t z = (*estado += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/* ------------------------------------------------------------
+ * simularSessao() – uma caminhada aleatória; devolve o número
+ * de salas visitadas
+ * ------------------------------------------------------------ */
+static uint32_t simularSessao(const Simulacao* sim, Sessao* sessao, uint64_t indice) {
+    uint64_t rng = sim->semente ^ (indice * 0xd1b54a32d192ed03ull);
+    uint32_t visitadas = 0;
+    const SalaCompacta* salas = sim->mapa->salas;
+    uint32_t atual = 0;
+    for (;;) {
+        const SalaCompacta* sala = &salas[atual];
+        visitadas++;
+        if (sala->pista != SEM_INDICE) coletarPistaId(sessao, sim->ht, sala->pista);
+        uint64_t r = proximoAleatorio(&rng);
+        if ((sala->esq == SEM_INDICE && sala->dir == SEM_INDICE) || visitadas >= sim->maxPassos
+            || r % 100 < SIM_PARADA) break;
+        if (sala->esq == SEM_INDICE) atual = sala->dir;
+        else if (sala->dir == SEM_INDICE) atual = sala->esq;
+        else atual = (r >> 32) & 1 ? sala->dir : sala->esq;
+    }
+    sessao->salasVisitadas = visitadas;
+    return visitadas;
+}
+
+/* pegarLote() – dono consome o primeiro lote da própria faixa */
+static int pegarLote(TrabalhadorSim* t, uint32_t* lote) {
+    uint64_t f = atomic_load_explicit(&t->faixa, memory_order_relaxed);
+    for (;;) {
+        uint32_t ini = (uint32_t) (f >> 32), fim = (uint32_t) f;
+        if (ini >= fim) return 0;
+        uint64_t novo = ((uint64_t) (ini + 1) << 32) | fim;
+        if (atomic_compare_exchange_weak(&t->faixa, &f, novo)) { *lote = ini; return 1; }
+    }
+}
+
+/* roubarLotes() – tira a metade final da faixa da vítima e a
+ * adota como nova faixa do ladrão */
+static int roubarLotes(TrabalhadorSim* ladrao, TrabalhadorSim* vitima) {
+    uint64_t f = atomic_load_explicit(&vitima->faixa, memory_order_relaxed);
+    for (;;) {
+        uint32_t ini = (uint32_t) (f >> 32), fim = (uint32_t) f;
+        if (ini >= fim) return 0;
+        uint32_t meio = fim - (fim - ini + 1) / 2;
+        uint64_t novo = ((uint64_t) ini << 32) | meio;
+        if (atomic_compare_exchange_weak(&vitima->faixa, &f, novo)) {
+            atomic_store(&ladrao->faixa, ((uint64_t) meio << 32) | fim);
+            return 1;
+        }
+    }
+}
+
+static void* trabalharSim(void* arg) {
+    TrabalhadorSim* t = (TrabalhadorSim*) arg;
+    const Simulacao* sim = t->sim;
+    Sessao sessao;
+    iniciarSessao(&sessao);
+    uint32_t numSusp = sim->ht->numSuspeitos;
+
+    for (;;) {
+        uint32_t lote;
+        if (!pegarLote(t, &lote)) {
+            int roubou = 0;
+            for (uint32_t k = 1; k < t->numTrabalhadores && !roubou; ++k)
+                roubou = roubarLotes(t, &t->todos[(t->id + k) % t->numTrabalhadores]);
+            if (!roubou) break;
+            continue;
+        }
+        uint64_t ini = (uint64_t) lote * SIM_LOTE;
+        uint64_t fim = ini + SIM_LOTE < sim->numSessoes ? ini + SIM_LOTE : sim->numSessoes;
+        for (uint64_t i = ini; i < fim; ++i) {
+            reiniciarSessao(&sessao);
+            t->salasVisitadas += simularSessao(sim, &sessao, i);
+            t->pistasColetadas += sessao.numPistas;
+            // 'ordem' é decrescente: basta andar enquanto o peso sustentar
+            uint32_t k = 0;
+            while (k < sessao.numSuspeitos && sessao.votos[sessao.ordem[k]] >= PESO_SUSTENTA) {
+                uint32_t id = sessao.ordem[k++];
+                if (id < numSusp) t->condenacoes[id]++;
+            }
+            if (k == 0) t->semCondenacao++;
+        }
+        t->sessoes += fim - ini;
+    }
+    liberarSessao(&sessao);
+    ESTAT(acumularEstatisticas());
+    return NULL;
+}
+
+static double segundosAgora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* carregarAssociacoesCenario() – leva todas as associações do
+ * cenário para a hash (necessário antes de compartilhá-la) */
+void carregarAssociacoesCenario(HashTable* ht, const Cenario* c) {
+    registrarSuspeitosCenario(ht, c);
+    for (uint32_t i = 0; i < c->cab->numPistas; ++i) associarPistaCenario(ht, c, i);
+}
+
+/* ------------------------------------------------------------
+ * simularSessoes() – distribui as sessões entre as threads,
+ * soma os resultados e imprime o resumo em 'out'
+ * ------------------------------------------------------------ */
+void simularSessoes(const Simulacao* sim, uint32_t numThreads, FILE* out) {
+    if (numThreads == 0) numThreads = 1;
+    uint64_t numLotes = (sim->numSessoes + SIM_LOTE - 1) / SIM_LOTE;
+    if (numLotes > UINT32_MAX) { fprintf(stderr, "Sessões demais para simular.\n"); return; }
+    uint32_t numSusp = sim->ht->numSuspeitos;
+
+    TrabalhadorSim* ts = (TrabalhadorSim*) aligned_alloc(SIM_ALINHAMENTO,
+        ((numThreads * sizeof(TrabalhadorSim) + SIM_ALINHAMENTO - 1) / SIM_ALINHAMENTO) * SIM_ALINHAMENTO);
+    uint64_t* condenacoes = (uint64_t*) calloc((size_t) numThreads * (numSusp + 8), sizeof(uint64_t));
+    if (!ts || !condenacoes) { fprintf(stderr, "Falha ao alocar simulador.\n"); exit(1); }
+
+    double t0 = segundosAgora();
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        TrabalhadorSim* t = &ts[i];
+        memset(t, 0, sizeof(*t));
+        uint64_t ini = numLotes * i / numThreads, fim = numLotes * (i + 1) / numThreads;
+        atomic_init(&t->faixa, (ini << 32) | fim);
+        t->sim = sim;
+        t->todos = ts;
+        t->id = i;
+        t->numTrabalhadores = numThreads;
+        t->condenacoes = condenacoes + (size_t) i * (numSusp + 8);  // +8: sem falso compartilhamento
+    }
+    for (uint32_t i = 1; i < numThreads; ++i) {
+        if (pthread_create(&ts[i].thread, NULL, trabalharSim, &ts[i]) != 0) {
+            fprintf(stderr, "Falha ao criar thread do simulador.\n");
+            exit(1);
+        }
+    }
+    trabalharSim(&ts[0]);
+    for (uint32_t i = 1; i < numThreads; ++i) pthread_join(ts[i].thread, NULL);
+    double dt = segundosAgora() - t0;
+
+    uint64_t sessoes = 0, semCond = 0, salas = 0, pistas = 0;
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        sessoes += ts[i].sessoes;
+        semCond += ts[i].semCondenacao;
+        salas   += ts[i].salasVisitadas;
+        pistas  += ts[i].pistasColetadas;
+        if (i) for (uint32_t s = 0; s < numSusp; ++s) ts[0].condenacoes[s] += ts[i].condenacoes[s];
+    }
+
+    fprintf(out, "Sessões simuladas: %llu em %.3f s (%.0f sessões/s, %u threads)\n",
+            (unsigned long long) sessoes, dt, dt > 0 ? sessoes / dt : 0.0, numThreads);
+    fprintf(out, "Média: %.2f salas e %.2f pistas por sessão\n",
+            sessoes ? (double) salas / sessoes : 0.0, sessoes ? (double) pistas / sessoes : 0.0);
+    fprintf(out, "Acusações sustentáveis (peso >= %u) por suspeito:\n", PESO_SUSTENTA);
+    for (uint32_t s = 0; s < numSusp; ++s) {
+        const char* nome = nomeSuspeito(sim->ht, s);
+        int pad = 20 - colunasUtf8(nome);
+        fprintf(out, "  %s%*s %12llu (%.2f%%)\n", nome, pad > 0 ? pad : 0, "",
+                (unsigned long long) ts[0].condenacoes[s],
+                sessoes ? 100.0 * ts[0].condenacoes[s] / sessoes : 0.0);
+    }
+    fprintf(out, "  %s%*s %12llu (%.2f%%)\n", "(ninguém)", 20 - colunasUtf8("(ninguém)"), "",
+            (unsigned long long) semCond, sessoes ? 100.0 * semCond / sessoes : 0.0);
+
+    free(condenacoes);
+    free(ts);
+}
+
+/* ============================================================
+   Rotas ótimas (validação de cenários)
+   Na exploração só se desce (e/d), então uma rota é o caminho da
+   raiz até uma sala e as pistas dela são as das salas no caminho.
+   Para cada suspeito, a menor rota que sustenta a acusação (regra
+   de verificarSuspeitoFinal(): soma dos pesos >= 2) é a sala mais
+   rasa onde a soma acumulada no caminho chega a 2.
+
+   Programação dinâmica de cima para baixo: uma busca em
+   profundidade (pilha explícita) carrega a soma por suspeito e
+   quantas vezes cada pista já apareceu no caminho (pista repetida
+   não conta duas vezes), somando ao entrar e desfazendo ao sair.
+   Paralelismo por subárvores: o topo da árvore é expandido em
+   largura até haver ROTAS_TAREFAS_POR_THREAD subárvores por
+   thread; cada thread pega subárvores por um contador atômico,
+   reconstrói o estado do prefixo subindo pelos pais e faz a busca
+   sozinha. Os melhores resultados são combinados no fim.
+   A busca anda sobre o mapa compacto (ESTRUTURA 8) em ordem van
+   Emde Boas, e um mapa que não é árvore (sala com dois pais) é
+   recusado antes de começar.
+   ============================================================ */
+#define ROTAS_TAREFAS_POR_THREAD 16
+
+typedef struct ArvoreRotas {
+    const MapaSalas* mapa;      // salas em ordem van Emde Boas (ESTRUTURA 8)
+    uint32_t* pista;            // por posição: índice denso da pista na hash (SEM_INDICE = nenhuma)
+} ArvoreRotas;
+
+typedef struct ResolvedorRotas {
+    const ArvoreRotas* arv;
+    const HashTable*   ht;
+    uint32_t*          tarefas;     // raízes das subárvores
+    uint32_t           numTarefas;
+    _Atomic uint32_t   proxima;
+} ResolvedorRotas;
+
+typedef struct TrabalhadorRotas {
+    ResolvedorRotas* r;
+    uint64_t*  melhor;          // por suspeito: (profundidade << 32) | origem; UINT64_MAX = nenhuma
+    uint32_t*  salaMelhor;      // por suspeito: posição da sala em 'melhor'
+    uint32_t*  pontos;          // soma dos pesos no caminho atual
+    uint32_t*  naTrilha;        // por pista: vezes que aparece no caminho atual
+    uint32_t*  prefixo;         // salas acima da subárvore, da raiz para baixo
+    uint32_t   capPrefixo;
+    uint64_t   limite;          // maior profundidade ainda útil
+    uint32_t   pendentes;       // suspeitos ainda sem rota
+    uint64_t   salas;
+    pthread_t  thread;
+} TrabalhadorRotas;
+
+/* montarArvoreRotas() – índice denso da pista de cada sala do mapa */
+void montarArvoreRotas(ArvoreRotas* a, const MapaSalas* mapa, const HashTable* ht) {
+    a->mapa = mapa;
+    a->pista = (uint32_t*) malloc((mapa->n ? mapa->n : 1) * sizeof(uint32_t));
+    if (!a->pista) { fprintf(stderr, "Falha ao alocar rotas.\n"); exit(1); }
+    for (uint32_t i = 0; i < mapa->n; ++i) {
+        uint32_t t = mapa->salas[i].pista;
+        a->pista[i] = t != SEM_INDICE ? indicePista(ht, t) : SEM_INDICE;
+    }
+}
+
+void liberarArvoreRotas(ArvoreRotas* a) {
+    free(a->pista);
+}
+
+/* recalcularLimite() – profundidade a partir da qual descer não
+ * melhora mais nenhum suspeito (todos resolvidos mais acima) */
+static void recalcularLimite(TrabalhadorRotas* t) {
+    uint64_t lim = 0;
+    t->pendentes = 0;
+    for (uint32_t s = 0; s < t->r->ht->numSuspeitos; ++s) {
+        uint64_t p = t->melhor[s] >> 32;
+        if (p > lim) lim = p;
+        t->pendentes += t->melhor[s] == UINT64_MAX;
+    }
+    t->limite = lim;
+}
+
+/* entrarSala()/sairSala() – soma ou desfaz a pista da sala no caminho */
+static void entrarSala(TrabalhadorRotas* t, uint32_t sala, uint32_t prof) {
+    const HashTable* ht = t->r->ht;
+    uint32_t p = t->r->arv->pista[sala];
+    if (p == SEM_INDICE || t->naTrilha[p]++) return;
+    int melhorou = 0;
+    for (const Relacao* rel = ht->relacoes[p]; rel; rel = rel->prox) {
+        uint32_t s = rel->suspeito, antes = t->pontos[s];
+        t->pontos[s] += rel->peso;
+        // regra de verificarSuspeitoFinal(): soma >= PESO_SUSTENTA
+        if (antes < PESO_SUSTENTA && t->pontos[s] >= PESO_SUSTENTA) {
+            // empate na profundidade: vence a sala de menor índice na
+            // fonte (a mais à esquerda, na mansão)
+            uint64_t v = ((uint64_t) prof << 32) | t->r->arv->mapa->origem[sala];
+            if (v < t->melhor[s]) {
+                // enquanto houver suspeito sem rota o limite não cai; depois,
+                // só cai quando quem melhorou estava no limite
+                uint64_t antiga = t->melhor[s] >> 32;
+                if (t->melhor[s] == UINT64_MAX) t->pendentes--;
+                t->melhor[s] = v;
+                t->salaMelhor[s] = sala;
+                melhorou |= t->pendentes == 0 && antiga >= t->limite;
+            }
+        }
+    }
+    if (melhorou) recalcularLimite(t);
+}
+
+static void sairSala(TrabalhadorRotas* t, uint32_t sala) {
+    uint32_t p = t->r->arv->pista[sala];
+    if (p == SEM_INDICE || --t->naTrilha[p]) return;
+    for (const Relacao* rel = t->r->ht->relacoes[p]; rel; rel = rel->prox) t->pontos[rel->suspeito] -= rel->peso;
+}
+
+/* ------------------------------------------------------------
+ * resolverSubarvore() – busca em profundidade a partir de 'raiz'
+ * (na profundidade 'prof'), com o estado do caminho até o pai dela
+ * já carregado. Pilha explícita: cada entrada é (sala, fase).
+ * ------------------------------------------------------------ */
+static void resolverSubarvore(TrabalhadorRotas* t, uint32_t raiz, uint32_t prof) {
+    const SalaCompacta* salas = t->r->arv->mapa->salas;
+    size_t cap = 256, topo = 0;
+    uint64_t* pilha = (uint64_t*) malloc(cap * sizeof(uint64_t));   // (sala << 1) | já entrou
+    if (!pilha) { fprintf(stderr, "Falha ao alocar pilha.\n"); exit(1); }
+    pilha[topo++] = (uint64_t) raiz << 1;
+    uint32_t p = prof;
+    while (topo) {
+        uint64_t item = pilha[--topo];
+        uint32_t s = (uint32_t) (item >> 1);
+        if (item & 1) { sairSala(t, s); p--; continue; }
+        // ninguém melhora daqui para baixo (empate na mesma profundidade
+        // ainda é visitado: vence a sala de menor índice na fonte)
+        if (p > t->limite) continue;
+        entrarSala(t, s, p);
+        t->salas++;
+        p++;
+        if (topo + 3 > cap) {
+            cap *= 2;
+            uint64_t* nova = (uint64_t*) realloc(pilha, cap * sizeof(uint64_t));
+            if (!nova) { fprintf(stderr, "Falha ao alocar pilha.\n"); exit(1); }
+            pilha = nova;
+        }
+        pilha[topo++] = ((uint64_t) s << 1) | 1;
+        if (salas[s].dir != SEM_INDICE) pilha[topo++] = (uint64_t) salas[s].dir << 1;
+        if (salas[s].esq != SEM_INDICE) pilha[topo++] = (uint64_t) salas[s].esq << 1;
+    }
+    free(pilha);
+}
+
+/* entrarPrefixo() – carrega o caminho da raiz até 'sala' (inclusive),
+ * de cima para baixo, para que o registro de profundidade seja o certo.
+ * Retorna a profundidade de 'sala'. */
+static uint32_t entrarPrefixo(TrabalhadorRotas* t, uint32_t sala) {
+    const SalaCompacta* salas = t->r->arv->mapa->salas;
+    uint32_t prof = 0;
+    for (uint32_t s = sala; s != SEM_INDICE; s = salas[s].pai) {
+        if (prof == t->capPrefixo) {
+            t->capPrefixo = t->capPrefixo ? t->capPrefixo * 2 : 64;
+            t->prefixo = (uint32_t*) realloc(t->prefixo, t->capPrefixo * sizeof(uint32_t));
+            if (!t->prefixo) { fprintf(stderr, "Falha ao alocar rotas.\n"); exit(1); }
+        }
+        t->prefixo[prof++] = s;
+    }
+    for (uint32_t k = 0; k < prof; ++k) entrarSala(t, t->prefixo[prof - 1 - k], k);
+    return prof - 1;
+}
+
+static void sairPrefixo(TrabalhadorRotas* t, uint32_t sala) {
+    for (uint32_t s = sala; s != SEM_INDICE; s = t->r->arv->mapa->salas[s].pai) sairSala(t, s);
+}
+
+static void* trabalharRotas(void* arg) {
+    TrabalhadorRotas* t = (TrabalhadorRotas*) arg;
+    ResolvedorRotas* r = t->r;
+    const SalaCompacta* salas = r->arv->mapa->salas;
+    uint32_t i;
+    recalcularLimite(t);
+    while ((i = atomic_fetch_add_explicit(&r->proxima, 1, memory_order_relaxed)) < r->numTarefas) {
+        uint32_t raiz = r->tarefas[i], pai = salas[raiz].pai;
+        uint32_t prof = pai == SEM_INDICE ? 0 : entrarPrefixo(t, pai) + 1;
+        resolverSubarvore(t, raiz, prof);
+        if (pai != SEM_INDICE) sairPrefixo(t, pai);
+    }
+    return NULL;
+}
+
+/* ------------------------------------------------------------
+ * resolverRotas() – menor rota por suspeito; imprime em 'out'
+ * "suspeito<TAB>movimentos<TAB>caminho" ("-" se não há rota).
+ * Retorna quantos suspeitos não podem ser condenados.
+ * ------------------------------------------------------------ */
+uint32_t resolverRotas(FILE* out, const ArvoreRotas* a, const HashTable* ht, uint32_t numThreads) {
+    if (numThreads == 0) numThreads = 1;
+    uint32_t numSusp = ht->numSuspeitos;
+    const SalaCompacta* salas = a->mapa->salas;
+    double t0 = segundosAgora();
+
+    // topo da árvore em largura: as salas expandidas viram a fila de
+    // uma thread só; as da fronteira viram tarefas
+    ResolvedorRotas r;
+    memset(&r, 0, sizeof(r));
+    r.arv = a;
+    r.ht = ht;
+    uint32_t alvo = numThreads == 1 ? 1 : numThreads * ROTAS_TAREFAS_POR_THREAD;
+    uint32_t cap = alvo * 2 + 2, ini = 0, fim = 0;
+    uint32_t* fila = (uint32_t*) malloc(cap * sizeof(uint32_t));
+    if (!fila) { fprintf(stderr, "Falha ao alocar rotas.\n"); exit(1); }
+    fila[fim++] = 0;
+    uint32_t expandidas = 0;
+    while (ini < fim && fim - ini < alvo) {
+        uint32_t s = fila[ini++];
+        expandidas++;
+        if (salas[s].esq != SEM_INDICE) fila[fim++] = salas[s].esq;
+        if (salas[s].dir != SEM_INDICE) fila[fim++] = salas[s].dir;
+        if (fim + 2 > cap) break;
+    }
+    r.tarefas = fila + ini;
+    r.numTarefas = fim - ini;
+
+    TrabalhadorRotas* ts = (TrabalhadorRotas*) calloc(numThreads, sizeof(TrabalhadorRotas));
+    if (!ts) { fprintf(stderr, "Falha ao alocar rotas.\n"); exit(1); }
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        ts[i].r = &r;
+        ts[i].melhor = (uint64_t*) malloc((numSusp ? numSusp : 1) * sizeof(uint64_t));
+        ts[i].salaMelhor = (uint32_t*) calloc(numSusp ? numSusp : 1, sizeof(uint32_t));
+        ts[i].pontos = (uint32_t*) calloc(numSusp ? numSusp : 1, sizeof(uint32_t));
+        ts[i].naTrilha = (uint32_t*) calloc(ht->numPistas ? ht->numPistas : 1, sizeof(uint32_t));
+        if (!ts[i].melhor || !ts[i].salaMelhor || !ts[i].pontos || !ts[i].naTrilha) { fprintf(stderr, "Falha ao alocar rotas.\n"); exit(1); }
+        memset(ts[i].melhor, 0xFF, numSusp * sizeof(uint64_t));
+    }
+    // as salas expandidas também são rotas candidatas: cada uma é
+    // avaliada só com ela mesma a mais sobre o caminho dos pais
+    for (uint32_t k = 0; k < expandidas; ++k) {
+        entrarPrefixo(&ts[0], fila[k]);
+        sairPrefixo(&ts[0], fila[k]);
+        ts[0].salas++;
+    }
+    for (uint32_t i = 1; i < numThreads; ++i) {
+        memcpy(ts[i].melhor, ts[0].melhor, numSusp * sizeof(uint64_t));
+        memcpy(ts[i].salaMelhor, ts[0].salaMelhor, numSusp * sizeof(uint32_t));
+        if (pthread_create(&ts[i].thread, NULL, trabalharRotas, &ts[i]) != 0) {
+            fprintf(stderr, "Falha ao criar thread do resolvedor.\n");
+            exit(1);
+        }
+    }
+    trabalharRotas(&ts[0]);
+    uint64_t visitas = ts[0].salas;
+    for (uint32_t i = 1; i < numThreads; ++i) {
+        pthread_join(ts[i].thread, NULL);
+        visitas += ts[i].salas;
+        for (uint32_t s = 0; s < numSusp; ++s)
+            if (ts[i].melhor[s] < ts[0].melhor[s]) {
+                ts[0].melhor[s] = ts[i].melhor[s];
+                ts[0].salaMelhor[s] = ts[i].salaMelhor[s];
+            }
+    }
+    double dt = segundosAgora() - t0;
+
+    uint32_t impossiveis = 0;
+    char* caminho = NULL;
+    size_t capCaminho = 0;
+    for (uint32_t s = 0; s < numSusp; ++s) {
+        uint64_t m = ts[0].melhor[s];
+        if (m == UINT64_MAX) {
+            fprintf(out, "%s\t-\t\n", nomeSuspeito(ht, s));
+            impossiveis++;
+            continue;
+        }
+        uint32_t prof = (uint32_t) (m >> 32), sala = ts[0].salaMelhor[s];
+        if (prof + 1 > capCaminho) {
+            capCaminho = prof + 1;
+            caminho = (char*) realloc(caminho, capCaminho);
+            if (!caminho) { fprintf(stderr, "Falha ao alocar caminho.\n"); exit(1); }
+        }
+        caminho[prof] = '\0';
+        for (uint32_t q = sala, k = prof; k-- > 0; q = salas[q].pai)
+            caminho[k] = salas[salas[q].pai].esq == q ? 'e' : 'd';
+        fprintf(out, "%s\t%u\t%s\n", nomeSuspeito(ht, s), prof, caminho);
+    }
+    fprintf(stderr, "Rotas: %u salas, %llu visitas em %.3f s (%u threads, %u subárvores); "
+                    "%u suspeito(s) sem rota\n",
+            a->mapa->n, (unsigned long long) visitas, dt, numThreads, r.numTarefas, impossiveis);
+
+    free(caminho);
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        free(ts[i].melhor);
+        free(ts[i].salaMelhor);
+        free(ts[i].pontos);
+        free(ts[i].naTrilha);
+        free(ts[i].prefixo);
+    }
+    free(ts);
+    free(fila);
+    return impossiveis;
+}
+
+/* ============================================================
+   ESTRUTURA 7: Associações ao vivo (publicação RCU + épocas)
+   Cada conjunto de associações é uma HashTable imutável depois
+   de publicada. Trocar de conjunto é uma troca atômica do
+   ponteiro 'atual'; leitores nunca esperam nem travam.
+   - Consultas avulsas (encontrarSuspeitoVivo) marcam a época
+     global no slot da thread, leem e desmarcam. Os nomes vêm do
+     pool de textos, então continuam válidos depois da leitura.
+   - Sessões prendem uma versão do começo ao fim (contador 'usos'),
+     assim os votos e a evidência nunca misturam duas tabelas.
+     A época protege só o instante entre ler 'atual' e somar o uso.
+   Quem publica espera o período de graça (todo slot ativo já viu a
+   época nova) e então solta a referência da versão antiga; o
+   último a soltar libera a tabela.
+   Há LEITORES_MAX slots, um por thread, nunca devolvidos; o
+   servidor não passa desse número de threads. Uma thread que
+   chegue sem slot lê sob a trava de quem publica (mais lento,
+   mas correto: a troca e o período de graça acontecem com ela).
+   ============================================================ */
+#define LEITORES_MAX 256
+#define RECARGA_MS   500        // intervalo de verificação do arquivo
+
+typedef struct VersaoAssociacoes {
+    HashTable*       ht;
+    uint64_t         numero;
+    _Atomic uint32_t usos;      // sessões presas + 1 enquanto publicada
+} VersaoAssociacoes;
+
+typedef struct SlotLeitor {
+    _Alignas(SIM_ALINHAMENTO) _Atomic uint64_t epoca;   // 0 = fora de leitura
+} SlotLeitor;
+
+typedef struct AssociacoesVivas {
+    _Atomic(VersaoAssociacoes*) atual;
+    _Atomic uint64_t epoca;
+    SlotLeitor       leitores[LEITORES_MAX];
+    _Atomic uint32_t numLeitores;
+    pthread_mutex_t  trava;     // entre quem publica (e leitores sem slot)
+    _Atomic uint64_t recargas;
+} AssociacoesVivas;
+
+static _Thread_local int slotLeitor = -1;
+static _Thread_local const AssociacoesVivas* slotDe;
+
+void iniciarAssociacoesVivas(AssociacoesVivas* av, HashTable* ht) {
+    memset(av, 0, sizeof(*av));
+    VersaoAssociacoes* v = (VersaoAssociacoes*) calloc(1, sizeof(VersaoAssociacoes));
+    if (!v) { fprintf(stderr, "Falha ao alocar associações.\n"); exit(1); }
+    v->ht = ht;
+    v->numero = 1;
+    atomic_init(&v->usos, 1);
+    atomic_init(&av->atual, v);
+    atomic_init(&av->epoca, 1);
+    pthread_mutex_init(&av->trava, NULL);
+}
+
+/* meuSlot() – slot da thread (NULL se todos já foram tomados) */
+static SlotLeitor* meuSlot(AssociacoesVivas* av) {
+    if (slotDe != av) {
+        uint32_t i = atomic_load(&av->numLeitores);
+        while (i < LEITORES_MAX && !atomic_compare_exchange_weak(&av->numLeitores, &i, i + 1)) {}
+        slotLeitor = i < LEITORES_MAX ? (int) i : -1;
+        slotDe = av;
+    }
+    return slotLeitor >= 0 ? &av->leitores[slotLeitor] : NULL;
+}
+
+/* entrarLeitura()/sairLeitura() – seção de leitura (sem espera,
+ * exceto para quem ficou sem slot) */
+static VersaoAssociacoes* entrarLeitura(AssociacoesVivas* av, SlotLeitor* s) {
+    if (s) atomic_store(&s->epoca, atomic_load(&av->epoca));   // seq_cst: antes de ler 'atual'
+    else   pthread_mutex_lock(&av->trava);
+    return atomic_load(&av->atual);
+}
+
+static void sairLeitura(AssociacoesVivas* av, SlotLeitor* s) {
+    if (s) atomic_store_explicit(&s->epoca, 0, memory_order_release);
+    else   pthread_mutex_unlock(&av->trava);
+}
+
+/* ------------------------------------------------------------
+ * prenderAssociacoes() – versão atual, presa até soltar; é o que
+ * uma sessão usa do começo ao fim
+ * ------------------------------------------------------------ */
+VersaoAssociacoes* prenderAssociacoes(AssociacoesVivas* av) {
+    SlotLeitor* s = meuSlot(av);
+    VersaoAssociacoes* v = entrarLeitura(av, s);
+    atomic_fetch_add_explicit(&v->usos, 1, memory_order_relaxed);
+    sairLeitura(av, s);
+    return v;
+}
+
+void soltarAssociacoes(VersaoAssociacoes* v) {
+    if (atomic_fetch_sub_explicit(&v->usos, 1, memory_order_acq_rel) == 1) {
+        liberarHash(v->ht);
+        free(v);
+    }
+}
+
+/* encontrarSuspeitoVivo() – consulta avulsa na versão mais nova */
+const char* encontrarSuspeitoVivo(AssociacoesVivas* av, const char* pista) {
+    SlotLeitor* s = meuSlot(av);
+    VersaoAssociacoes* v = entrarLeitura(av, s);
+    const char* nome = encontrarSuspeito(v->ht, pista);
+    sairLeitura(av, s);
+    return nome;
+}
+
+/* ------------------------------------------------------------
+ * publicarAssociacoes() – torna 'ht' a versão atual. Volta depois
+ * do período de graça; a versão antiga some quando a última
+ * sessão presa a ela terminar.
+ * ------------------------------------------------------------ */
+void publicarAssociacoes(AssociacoesVivas* av, HashTable* ht) {
+    VersaoAssociacoes* v = (VersaoAssociacoes*) calloc(1, sizeof(VersaoAssociacoes));
+    if (!v) { fprintf(stderr, "Falha ao alocar associações.\n"); exit(1); }
+    v->ht = ht;
+    atomic_init(&v->usos, 1);
+
+    pthread_mutex_lock(&av->trava);
+    VersaoAssociacoes* antiga = atomic_load(&av->atual);
+    v->numero = antiga->numero + 1;
+    atomic_store(&av->atual, v);
+    uint64_t nova = atomic_fetch_add(&av->epoca, 1) + 1;
+    // período de graça: quem ainda está numa leitura começada antes
+    // da troca pode ter visto 'antiga' e estar prestes a prendê-la
+    uint32_t n = atomic_load(&av->numLeitores);
+    for (uint32_t i = 0; i < n; ++i) {
+        uint64_t e;
+        while ((e = atomic_load(&av->leitores[i].epoca)) != 0 && e < nova) sched_yield();
+    }
+    atomic_fetch_add(&av->recargas, 1);
+    pthread_mutex_unlock(&av->trava);
+    soltarAssociacoes(antiga);
+}
+
+/* encerrarAssociacoesVivas() – sem leitores: solta a versão atual */
+void encerrarAssociacoesVivas(AssociacoesVivas* av) {
+    soltarAssociacoes(atomic_load(&av->atual));
+    atomic_store(&av->atual, NULL);
+    pthread_mutex_destroy(&av->trava);
+}
+
+/* ------------------------------------------------------------
+ * montarAssociacoes() – uma tabela nova: associações do mapa
+ * (mansão padrão ou cenário) mais as do arquivo. NULL se o
+ * arquivo não abriu ou tem erro (a versão em uso continua).
+ * ------------------------------------------------------------ */
+HashTable* montarAssociacoes(const Cenario* c, const char* arquivo) {
+    HashTable* ht = criarHash(101);
+    if (c) carregarAssociacoesCenario(ht, c);
+    else   carregarAssociacoes(ht);
+    if (arquivo && carregarArquivoAssociacoes(ht, arquivo) < 0) {
+        liberarHash(ht);
+        return NULL;
+    }
+    return ht;
+}
+
+/* ============================================================
+   Servidor de sessões (socket Unix local)
+   Cada conexão é uma sessão de jogo; o mapa é montado uma vez em
+   main() e só lido pelas threads (como no simulador). As
+   associações são uma versão ao vivo (ESTRUTURA 7), presa pela
+   sessão do começo ao fim; com --associacoes, o arquivo é
+   vigiado e cada mudança publica uma versão nova, usada pelas
+   sessões que começarem depois. Por conexão ficam só a Sessao
+   (arena, pistas, contadores), a sala atual e os buffers.
+
+   Todas as threads esperam no mesmo epoll; os descritores são
+   registrados com EPOLLONESHOT, então cada evento vai para uma
+   thread só e uma conexão nunca é atendida por duas threads ao
+   mesmo tempo – o estado dela dispensa trava. Depois de atender,
+   a thread rearma o descritor (leitura, ou escrita se a resposta
+   não coube no socket).
+
+   Protocolo: uma linha por comando, uma linha por resposta,
+   campos separados por TAB.
+     e | d         -> SALA\tnome\tpista\tsala à esquerda\tsala à direita
+     p             -> PISTAS\tn\tpista1\tpista2...
+     b trecho      -> BUSCA\tn\tpista1...      ("b ^início" = prefixo)
+     q pista       -> SUSPEITO\tpista\tnome     (versão mais nova, não a da sessão)
+     a suspeito    -> VEREDITO\tsuspeito\tpeso\tSUSTENTADA|NAO_SUSTENTADA (encerra)
+     s             -> FIM (encerra)
+   Ao conectar, o cliente recebe a SALA inicial. Erros viram
+   ERRO\tmotivo.
+   ============================================================ */
+#define SERV_ENTRADA_MAX 512     // linha mais longa aceita do cliente
+#define SERV_EVENTOS     64
+#define SERV_ESPERA_MS   200     // de quanto em quanto as threads olham o pedido de parada
+#define SERV_BUSCA_MAX   64
+
+typedef struct Conexao {
+    int      fd;
+    Sessao   sessao;
+    VersaoAssociacoes* versao;  // associações desta sessão
+    Sala*    sala;              // mansão em ponteiros ou...
+    uint32_t salaCenario;       // ...índice da sala no cenário
+    char     entrada[SERV_ENTRADA_MAX];
+    size_t   numEntrada;
+    TextoBuf saida;             // resposta ainda não enviada
+    size_t   enviados;
+    int      encerrar;          // fecha depois de enviar tudo
+    // repasse entre threads: release antes de rearmar, acquire ao
+    // receber o evento. O kernel já ordena epoll_ctl/epoll_wait; o
+    // atômico deixa isso explícito (e visível para o ThreadSanitizer)
+    _Atomic uint32_t repasses;
+    struct Conexao *ant, *prox; // conexões abertas (para fechar no fim)
+} Conexao;
+
+typedef struct Servidor {
+    Sala*          inicio;
+    const Cenario* cenario;
+    AssociacoesVivas assoc;
+    const char*    arqAssociacoes;  // vigiado se não for NULL
+    int            epfd, escuta;
+    Conexao*       abertas;
+    pthread_mutex_t trava;      // só para a lista 'abertas'
+    _Atomic uint64_t conexoes, sessoesJulgadas, comandos;
+} Servidor;
+
+static _Atomic int servidorParar;    // lido por todas as threads do servidor
+
+static void pararServidor(int sinal) {
+    int salvo = errno;
+    (void) sinal;
+    atomic_store(&servidorParar, 1);
+    errno = salvo;
+}
+
+static void responder(Conexao* c, const char* fmt, ...) {
+    va_list ap;
+    for (;;) {
+        size_t livre = c->saida.cap - c->saida.tam;
+        va_start(ap, fmt);
+        int n = vsnprintf(c->saida.dados + c->saida.tam, livre, fmt, ap);
+        va_end(ap);
+        if (n < 0) return;
+        if ((size_t) n < livre) { c->saida.tam += (size_t) n; return; }
+        size_t cap = c->saida.cap ? c->saida.cap * 2 : 256;
+        while (cap - c->saida.tam <= (size_t) n) cap *= 2;
+        char* d = (char*) realloc(c->saida.dados, cap);
+        if (!d) { fprintf(stderr, "Falha ao alocar resposta.\n"); exit(1); }
+        c->saida.dados = d;
+        c->saida.cap = cap;
+    }
+}
+
+/* entrarNaSala() – conta a visita, coleta a pista e descreve a sala */
+static void entrarNaSala(Servidor* sv, Conexao* c) {
+    const char *nome, *pista, *esq = "", *dir = "";
+    c->sessao.salasVisitadas++;
+    if (sv->cenario) {
+        const Cenario* cn = sv->cenario;
+        uint32_t e = filhoCenario(cn, c->salaCenario, 'e'), d = filhoCenario(cn, c->salaCenario, 'd');
+        nome = nomeSalaCenario(cn, c->salaCenario);
+        pista = pistaSalaCenario(cn, c->salaCenario);
+        if (e != SEM_INDICE) esq = nomeSalaCenario(cn, e);
+        if (d != SEM_INDICE) dir = nomeSalaCenario(cn, d);
+        RASTRO(RASTRO_SALA_CENARIO, sessaoRastro(&c->sessao), c->salaCenario, 0);
+    } else {
+        nome = nomeSala(c->sala);
+        RASTRO(RASTRO_SALA, sessaoRastro(&c->sessao), c->sala->nome, 0);
+        pista = textoPista(c->sala->pista);
+        if (c->sala->esquerda) esq = nomeSala(c->sala->esquerda);
+        if (c->sala->direita)  dir = nomeSala(c->sala->direita);
+    }
+    if (*pista) coletarPista(&c->sessao, c->versao->ht, pista);
+    responder(c, "SALA\t%s\t%s\t%s\t%s\n", nome, pista, esq, dir);
+}
+
+/* executarComando() – uma linha do cliente (sem o '\n') */
+static void executarComando(Servidor* sv, Conexao* c, char* linha) {
+    atomic_fetch_add_explicit(&sv->comandos, 1, memory_order_relaxed);
+    char op = linha[0];
+    const char* arg = linha[0] && linha[1] == ' ' ? linha + 2 : "";
+    if ((op == 'e' || op == 'd') && !linha[1]) {
+        int moveu = 0;
+        if (sv->cenario) {
+            uint32_t f = filhoCenario(sv->cenario, c->salaCenario, op);
+            if (f != SEM_INDICE) { c->salaCenario = f; moveu = 1; }
+        } else {
+            Sala* f = op == 'e' ? c->sala->esquerda : c->sala->direita;
+            if (f) { c->sala = f; moveu = 1; }
+        }
+        if (moveu) entrarNaSala(sv, c);
+        else       responder(c, "ERRO\tsem passagem para esse lado\n");
+    } else if (op == 'p' && !linha[1]) {
+        CursorPistas cur;
+        const char* p;
+        responder(c, "PISTAS\t%zu", c->sessao.numPistas);
+        cursorSessao(&cur, &c->sessao);
+        while ((p = cursorProxima(&cur)) != NULL) responder(c, "\t%s", p);
+        responder(c, "\n");
+    } else if (op == 'b' && *arg) {
+        const char* achadas[SERV_BUSCA_MAX];
+        size_t n = buscarNaSessao(&c->sessao, arg, achadas, SERV_BUSCA_MAX);
+        responder(c, "BUSCA\t%zu", n);
+        for (size_t i = 0; i < n; ++i) responder(c, "\t%s", achadas[i]);
+        responder(c, "\n");
+    } else if (op == 'q' && *arg) {
+        responder(c, "SUSPEITO\t%s\t%s\n", arg, encontrarSuspeitoVivo(&sv->assoc, arg));
+    } else if (op == 'a' && *arg) {
+        uint32_t votos = votosPara(&c->sessao, c->versao->ht, arg);
+        rastrearJulgamento(&c->sessao, c->versao->ht, arg, votos);
+        responder(c, "VEREDITO\t%s\t%u\t%s\n", arg, votos, votos >= PESO_SUSTENTA ? "SUSTENTADA" : "NAO_SUSTENTADA");
+        atomic_fetch_add_explicit(&sv->sessoesJulgadas, 1, memory_order_relaxed);
+        c->encerrar = 1;
+    } else if (op == 's' && !linha[1]) {
+        responder(c, "FIM\n");
+        c->encerrar = 1;
+    } else {
+        responder(c, "ERRO\tcomando desconhecido\n");
+    }
+}
+
+static void fecharConexao(Servidor* sv, Conexao* c) {
+    pthread_mutex_lock(&sv->trava);
+    if (c->ant) c->ant->prox = c->prox;
+    else        sv->abertas = c->prox;
+    if (c->prox) c->prox->ant = c->ant;
+    pthread_mutex_unlock(&sv->trava);
+    close(c->fd);
+    liberarSessao(&c->sessao);
+    soltarAssociacoes(c->versao);
+    free(c->saida.dados);
+    free(c);
+}
+
+/* rearmar() – devolve o descritor ao epoll (EPOLLONESHOT) */
+static int rearmar(Servidor* sv, int fd, Conexao* dono, uint32_t eventos) {
+    if (dono) atomic_fetch_add_explicit(&dono->repasses, 1, memory_order_release);
+    struct epoll_event ev;
+    ev.events = eventos | EPOLLONESHOT;
+    ev.data.ptr = dono;
+    return epoll_ctl(sv->epfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+/* aceitarConexoes() – aceita até esvaziar a fila do socket de escuta */
+static void aceitarConexoes(Servidor* sv) {
+    for (;;) {
+        int fd = accept(sv->escuta, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept");
+            break;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        Conexao* c = (Conexao*) calloc(1, sizeof(Conexao));
+        if (!c) { fprintf(stderr, "Falha ao alocar conexão.\n"); exit(1); }
+        c->fd = fd;
+        iniciarSessao(&c->sessao);
+        c->versao = prenderAssociacoes(&sv->assoc);
+        c->sala = sv->inicio;
+        c->salaCenario = sv->cenario ? sv->cenario->cab->raiz : SEM_INDICE;
+        entrarNaSala(sv, c);
+        pthread_mutex_lock(&sv->trava);
+        c->prox = sv->abertas;
+        if (sv->abertas) sv->abertas->ant = c;
+        sv->abertas = c;
+        pthread_mutex_unlock(&sv->trava);
+        atomic_fetch_add_explicit(&sv->conexoes, 1, memory_order_relaxed);
+
+        // a SALA inicial sai no primeiro EPOLLOUT
+        struct epoll_event ev;
+        ev.events = EPOLLOUT | EPOLLONESHOT;
+        ev.data.ptr = c;
+        atomic_store_explicit(&c->repasses, 1, memory_order_release);
+        if (epoll_ctl(sv->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) { perror("epoll_ctl"); fecharConexao(sv, c); }
+    }
+    if (rearmar(sv, sv->escuta, NULL, EPOLLIN) != 0) perror("epoll_ctl");
+}
+
+/* ------------------------------------------------------------
+ * atenderConexao() – lê o que chegou, executa as linhas
+ * completas e envia o que couber; rearma ou fecha a conexão
+ * ------------------------------------------------------------ */
+static void atenderConexao(Servidor* sv, Conexao* c, uint32_t eventos) {
+    atomic_load_explicit(&c->repasses, memory_order_acquire);
+    int fechar = (eventos & EPOLLERR) != 0;
+    while (!fechar && !c->encerrar && (eventos & (EPOLLIN | EPOLLHUP))) {
+        ssize_t r = read(c->fd, c->entrada + c->numEntrada, sizeof(c->entrada) - c->numEntrada);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) fechar = 1;
+            break;
+        }
+        if (r == 0) { fechar = 1; break; }
+        c->numEntrada += (size_t) r;
+        char* ini = c->entrada;
+        char* fim = c->entrada + c->numEntrada;
+        char* nl;
+        while (!c->encerrar && (nl = memchr(ini, '\n', (size_t) (fim - ini))) != NULL) {
+            *nl = '\0';
+            if (nl > ini && nl[-1] == '\r') nl[-1] = '\0';
+            executarComando(sv, c, ini);
+            ini = nl + 1;
+        }
+        c->numEntrada = (size_t) (fim - ini);
+        memmove(c->entrada, ini, c->numEntrada);
+        if (c->numEntrada == sizeof(c->entrada)) {
+            responder(c, "ERRO\tlinha longa demais\n");
+            c->encerrar = 1;
+        }
+    }
+
+    while (!fechar && c->enviados < c->saida.tam) {
+        ssize_t w = send(c->fd, c->saida.dados + c->enviados, c->saida.tam - c->enviados, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) fechar = 1;
+            break;
+        }
+        c->enviados += (size_t) w;
+    }
+    if (c->enviados == c->saida.tam) c->enviados = c->saida.tam = 0;
+
+    if (fechar || (c->encerrar && c->saida.tam == 0)) { fecharConexao(sv, c); return; }
+    uint32_t quer = c->saida.tam ? EPOLLOUT : EPOLLIN | EPOLLRDHUP;
+    if (rearmar(sv, c->fd, c, quer) != 0) { perror("epoll_ctl"); fecharConexao(sv, c); }
+}
+
+static void* trabalharServidor(void* arg) {
+    Servidor* sv = (Servidor*) arg;
+    struct epoll_event ev[SERV_EVENTOS];
+    while (!atomic_load_explicit(&servidorParar, memory_order_relaxed)) {
+        int n = epoll_wait(sv->epfd, ev, SERV_EVENTOS, SERV_ESPERA_MS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (!ev[i].data.ptr) aceitarConexoes(sv);
+            else                 atenderConexao(sv, (Conexao*) ev[i].data.ptr, ev[i].events);
+        }
+    }
+    ESTAT(acumularEstatisticas());
+    return NULL;
+}
+
+/* ------------------------------------------------------------
+ * vigiarAssociacoes() – thread que olha o arquivo de associações
+ * a cada RECARGA_MS e publica uma versão nova quando ele muda
+ * (inclusive quando é trocado por rename)
+ * ------------------------------------------------------------ */
+static void* vigiarAssociacoes(void* arg) {
+    Servidor* sv = (Servidor*) arg;
+    struct stat antes;
+    int conhecido = stat(sv->arqAssociacoes, &antes) == 0;
+    struct timespec espera = { RECARGA_MS / 1000, (RECARGA_MS % 1000) * 1000000L };
+    while (!atomic_load(&servidorParar)) {
+        nanosleep(&espera, NULL);
+        struct stat agora;
+        if (stat(sv->arqAssociacoes, &agora) != 0) continue;
+        if (conhecido && agora.st_ino == antes.st_ino && agora.st_size == antes.st_size
+            && agora.st_mtim.tv_sec == antes.st_mtim.tv_sec && agora.st_mtim.tv_nsec == antes.st_mtim.tv_nsec)
+            continue;
+        antes = agora;
+        conhecido = 1;
+        HashTable* ht = montarAssociacoes(sv->cenario, sv->arqAssociacoes);
+        if (!ht) {
+            fprintf(stderr, "Associações com erro; segue a versão %llu.\n",
+                    (unsigned long long) atomic_load(&sv->assoc.atual)->numero);
+            continue;
+        }
+        size_t relacoes = ht->ocupados;
+        publicarAssociacoes(&sv->assoc, ht);
+        fprintf(stderr, "Associações recarregadas: versão %llu, %zu relações.\n",
+                (unsigned long long) atomic_load(&sv->assoc.atual)->numero, relacoes);
+    }
+    return NULL;
+}
+
+/* ------------------------------------------------------------
+ * servirSessoes() – escuta em 'caminho' até SIGINT/SIGTERM.
+ * Retorna 0 ao parar normalmente, -1 se não conseguiu abrir.
+ * ------------------------------------------------------------ */
+int servirSessoes(const char* caminho, Sala* inicio, const Cenario* cenario, const char* arqAssociacoes,
+                  uint32_t numThreads) {
+    struct sockaddr_un end;
+    memset(&end, 0, sizeof(end));
+    end.sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(end.sun_path)) {
+        fprintf(stderr, "Caminho de socket longo demais: '%s'.\n", caminho);
+        return -1;
+    }
+    strcpy(end.sun_path, caminho);
+
+    Servidor sv;
+    memset(&sv, 0, sizeof(sv));
+    sv.inicio = inicio;
+    sv.cenario = cenario;
+    sv.arqAssociacoes = arqAssociacoes;
+    HashTable* ht = montarAssociacoes(cenario, arqAssociacoes);
+    if (!ht) return -1;
+    iniciarAssociacoesVivas(&sv.assoc, ht);
+    pthread_mutex_init(&sv.trava, NULL);
+    sv.escuta = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(caminho);
+    if (sv.escuta < 0 || fcntl(sv.escuta, F_SETFL, O_NONBLOCK) != 0 || bind(sv.escuta, (struct sockaddr*) &end, sizeof(end)) != 0
+        || listen(sv.escuta, SOMAXCONN) != 0) {
+        fprintf(stderr, "Não foi possível escutar em '%s': %s\n", caminho, strerror(errno));
+        if (sv.escuta >= 0) close(sv.escuta);
+        encerrarAssociacoesVivas(&sv.assoc);
+        return -1;
+    }
+    sv.epfd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = NULL;    // NULL = socket de escuta
+    if (sv.epfd < 0 || epoll_ctl(sv.epfd, EPOLL_CTL_ADD, sv.escuta, &ev) != 0) {
+        perror("epoll");
+        close(sv.escuta);
+        unlink(caminho);
+        encerrarAssociacoesVivas(&sv.assoc);
+        return -1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = pararServidor;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    atomic_store(&servidorParar, 0);
+
+    if (numThreads == 0) numThreads = 1;
+    if (numThreads > LEITORES_MAX) numThreads = LEITORES_MAX;
+    pthread_t* threads = (pthread_t*) malloc(numThreads * sizeof(pthread_t));
+    if (!threads) { fprintf(stderr, "Falha ao alocar threads.\n"); exit(1); }
+    fprintf(stderr, "Servidor ouvindo em %s (%u threads); Ctrl+C para parar.\n", caminho, numThreads);
+    double t0 = segundosAgora();
+    for (uint32_t i = 1; i < numThreads; ++i) {
+        if (pthread_create(&threads[i], NULL, trabalharServidor, &sv) != 0) {
+            fprintf(stderr, "Falha ao criar thread do servidor.\n");
+            exit(1);
+        }
+    }
+    pthread_t vigia;
+    int vigiando = arqAssociacoes && pthread_create(&vigia, NULL, vigiarAssociacoes, &sv) == 0;
+    trabalharServidor(&sv);
+    for (uint32_t i = 1; i < numThreads; ++i) pthread_join(threads[i], NULL);
+    if (vigiando) pthread_join(vigia, NULL);
+    double dt = segundosAgora() - t0;
+
+    while (sv.abertas) fecharConexao(&sv, sv.abertas);
+    uint64_t recargas = atomic_load(&sv.assoc.recargas);
+    encerrarAssociacoesVivas(&sv.assoc);
+    close(sv.epfd);
+    close(sv.escuta);
+    unlink(caminho);
+    pthread_mutex_destroy(&sv.trava);
+    free(threads);
+    uint64_t comandos = atomic_load(&sv.comandos);
+    fprintf(stderr, "Servidor parado: %llu conexões, %llu julgamentos, %llu comandos, "
+                    "%llu recarga(s) em %.1f s\n",
+            (unsigned long long) atomic_load(&sv.conexoes),
+            (unsigned long long) atomic_load(&sv.sessoesJulgadas),
+            (unsigned long long) comandos, (unsigned long long) recargas, dt);
+    return 0;
+}
+
+/* Ferramentas que reaproveitam as estruturas (ex.: benchmark)
+ * incluem este arquivo com DETECTIVE_SEM_MAIN definido. */
+#ifndef DETECTIVE_SEM_MAIN
+
+/* ============================================================
+   main() – monta o mapa fixo e roda o jogo
+   ============================================================ */
+static void mostrarUso(const char* prog) {
+    fprintf(stderr,
+        "Uso: %s [opções]\n"
+        "  -c, --cenario ARQ   joga um cenário binário em vez da mansão padrão\n"
+        "  --associacoes ARQ   relações extras pista<TAB>suspeito[<TAB>peso]\n"
+        "  --exportar ARQ      grava a mansão padrão no formato binário e sai\n"
+        "  --roteiro ARQ|-     roda sessões sem interação (uma por linha) e sai\n"
+        "  --caminho SALA      mostra os movimentos do início até SALA e sai\n"
+        "  --distancia A B     mostra a distância entre as salas A e B e sai\n"
+        "  --rotas             menor rota (e/d) que condena cada suspeito e sai\n"
+        "  --simular N         simula N sessões aleatórias e resume as acusações\n"
+        "  --servidor SOCKET   atende sessões por um socket Unix até Ctrl+C\n"
+        "                      (com --associacoes, recarrega o arquivo quando ele muda)\n"
+        "  --threads T         threads do simulador/servidor (padrão: núcleos disponíveis)\n"
+        "  --passos P          máximo de salas por sessão simulada (padrão: 64)\n"
+        "  --semente S         semente do simulador (padrão: 1)\n"
+        "  --salvar ARQ        habilita (g) no jogo: guarda a sessão em ARQ e sai\n"
+        "  --retomar ARQ       continua uma sessão guardada com --salvar\n"
+        "  --compacto          listagens em formato de máquina (pista<TAB>suspeito)\n"
+        "  --memoria           ao final, mostra o uso de memória (stderr)\n"
+        "  --estatisticas F    ao final, despeja estatísticas em stderr (F = texto|json)\n"
+        "  --rastro ARQ        grava um rastro binário das sessões (leia com ler_rastro)\n",
+        prog);
+}
+
+int main(int argc, char** argv) {
+    const char* arqCenario = NULL;
+    const char* arqExportar = NULL;
+    const char* arqRoteiro = NULL;
+    const char* arqSalvar = NULL;
+    const char* arqRetomar = NULL;
+    const char* arqAssociacoes = NULL;
+    const char* arqServidor = NULL;
+    const char* arqRastro = NULL;
+    int resolverRotasFlag = 0;
+    const char* salaOrigem = NULL;
+    const char* salaDestino = NULL;
+    int mostrarMemoria = 0;
+    const char* formatoEstat = NULL;
+    unsigned long long numSimulacoes = 0, semente = 1;
+    long numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long maxPassos = 64;
+    for (int i = 1; i < argc; ++i) {
+        if ((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--cenario") == 0) && i + 1 < argc) {
+            arqCenario = argv[++i];
+        } else if (strcmp(argv[i], "--associacoes") == 0 && i + 1 < argc) {
+            arqAssociacoes = argv[++i];
+        } else if (strcmp(argv[i], "--exportar") == 0 && i + 1 < argc) {
+            arqExportar = argv[++i];
+        } else if (strcmp(argv[i], "--roteiro") == 0 && i + 1 < argc) {
+            arqRoteiro = argv[++i];
+        } else if (strcmp(argv[i], "--caminho") == 0 && i + 1 < argc) {
+            salaOrigem = NULL;
+            salaDestino = argv[++i];
+        } else if (strcmp(argv[i], "--distancia") == 0 && i + 2 < argc) {
+            salaOrigem = argv[++i];
+            salaDestino = argv[++i];
+        } else if (strcmp(argv[i], "--simular") == 0 && i + 1 < argc) {
+            numSimulacoes = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc) {
+            arqServidor = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--passos") == 0 && i + 1 < argc) {
+            maxPassos = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--estatisticas") == 0 && i + 1 < argc) {
+            formatoEstat = argv[++i];
+        } else if (strcmp(argv[i], "--salvar") == 0 && i + 1 < argc) {
+            arqSalvar = argv[++i];
+        } else if (strcmp(argv[i], "--retomar") == 0 && i + 1 < argc) {
+            arqRetomar = argv[++i];
+        } else if (strcmp(argv[i], "--rastro") == 0 && i + 1 < argc) {
+            arqRastro = argv[++i];
+        } else if (strcmp(argv[i], "--rotas") == 0) {
+            resolverRotasFlag = 1;
+        } else if (strcmp(argv[i], "--compacto") == 0) {
+            saidaPadrao()->compacto = 1;
+        } else if (strcmp(argv[i], "--memoria") == 0) {
+            mostrarMemoria = 1;
+        } else {
+            mostrarUso(argv[0]);
+            return 1;
+        }
+    }
+
+    // o servidor tem um slot de leitura por thread (ESTRUTURA 7)
+    if (arqServidor && numThreads > LEITORES_MAX) {
+        fprintf(stderr, "O servidor usa no máximo %d threads.\n", LEITORES_MAX);
+        numThreads = LEITORES_MAX;
+    }
+
+    // o rastro liga antes da primeira sessão e das threads
+    if (arqRastro && abrirRastro(arqRastro) != 0) return 1;
+
+    // 1) Mansão (árvore binária fixa): pré-montada em tabelas
+    //    estáticas ou montada agora na arena do mapa
+    Arena mapa;
+    arenaIniciar(&mapa);
+    Sala* hall = mansaoPadrao(&mapa);
+
+    // 2) Abre a sessão (BST de pistas vazia no início)
+    Sessao sessao;
+    iniciarSessao(&sessao);
+
+    // 3) Cria a tabela hash (pista -> suspeito); no cenário binário
+    //    ela é preenchida conforme as pistas são coletadas
+    HashTable* ht;
+    Cenario cenario;
+    int usarCenario = 0;
+    if (arqCenario) {
+        if (abrirCenario(&cenario, arqCenario) != 0) return 1;
+        usarCenario = 1;
+        ht = criarHash(101);
+    } else {
+        ht = associacoesPadrao();
+    }
+    if (arqAssociacoes && carregarArquivoAssociacoes(ht, arqAssociacoes) < 0) return 1;
+
+    // 4) Modo escolhido: exportação, simulação, roteiro ou jogo interativo
+    int rc = 0;
+    if (arqExportar) {
+        rc = exportarCenario(arqExportar, hall, ht) == 0 ? 0 : 1;
+        if (rc == 0) printf("Cenário gravado em %s\n", arqExportar);
+    } else if (salaDestino) {
+        IndiceSalas ix;
+        if ((usarCenario ? indexarCenario(&ix, &cenario) : indexarMansao(&ix, hall)) != 0) {
+            fprintf(stderr, "O mapa não é uma árvore.\n");
+            rc = 1;
+        } else {
+            rc = consultarSalas(stdout, &ix, salaOrigem, salaDestino) == 0 ? 0 : 1;
+            liberarIndiceSalas(&ix);
+        }
+    } else if (arqServidor) {
+        // o servidor monta (e recarrega) as próprias versões das associações
+        rc = servirSessoes(arqServidor, hall, usarCenario ? &cenario : NULL, arqAssociacoes,
+                           numThreads > 0 ? (uint32_t) numThreads : 1) == 0 ? 0 : 1;
+    } else if (resolverRotasFlag) {
+        if (usarCenario) carregarAssociacoesCenario(ht, &cenario);
+        MapaSalas mapaCompacto;
+        montarMapa(&mapaCompacto, hall, usarCenario ? &cenario : NULL, MAPA_VEB);
+        if (!mapaCompacto.arvore) {
+            fprintf(stderr, "O mapa não é uma árvore.\n");
+            rc = 1;
+        } else {
+            ArvoreRotas arv;
+            montarArvoreRotas(&arv, &mapaCompacto, ht);
+            resolverRotas(stdout, &arv, ht, numThreads > 0 ? (uint32_t) numThreads : 1);
+            liberarArvoreRotas(&arv);
+        }
+        liberarMapa(&mapaCompacto);
+    } else if (numSimulacoes) {
+        if (usarCenario) carregarAssociacoesCenario(ht, &cenario);
+        MapaSalas mapaCompacto;
+        montarMapa(&mapaCompacto, hall, usarCenario ? &cenario : NULL, MAPA_VEB);
+        Simulacao sim = { &mapaCompacto, ht, numSimulacoes, (uint32_t) maxPassos, semente };
+        simularSessoes(&sim, numThreads > 0 ? (uint32_t) numThreads : 1, stdout);
+        liberarMapa(&mapaCompacto);
+    } else if (arqRoteiro) {
+        rc = executarRoteiros(arqRoteiro, hall, usarCenario ? &cenario : NULL, ht, saidaPadrao()) < 0 ? 1 : 0;
+    } else {
+        // salas são identificadas pelo índice em largura (no cenário,
+        // pelo próprio índice do arquivo)
+        uint32_t numSalas = usarCenario ? cenario.cab->numSalas : (uint32_t) contarSalas(hall);
+        uint32_t inicio = usarCenario ? cenario.cab->raiz : 0;
+        OrigemSnapshot origem = { numSalas, 0, 0 };
+        if (arqRetomar || arqSalvar) {
+            origem.mapa = usarCenario ? impressaoCenario(&cenario) : impressaoMansao(hall);
+            origem.associacoes = impressaoAssociacoes(ht);
+        }
+        if (arqRetomar && retomarSessao(arqRetomar, &sessao, ht, &origem, &inicio) != 0) rc = 1;
+        if (rc == 0) {
+            escrever(saidaPadrao(), "=== Detective Quest: Julgamento Final ===\n");
+            escrever(saidaPadrao(), "Navegação: (e) esquerda, (d) direita, (s) sair\n");
+            if (arqRetomar) escrever(saidaPadrao(), "Sessão retomada com %zu pista(s) coletada(s).\n",
+                                     sessao.numPistas);
+            uint32_t pausa;
+            if (usarCenario) {
+                pausa = explorarCenario(&cenario, inicio, ht, &sessao, arqSalvar != NULL);
+            } else {
+                Sala* parada = explorarSalas(salaDoIndice(hall, inicio), ht, &sessao, arqSalvar != NULL);
+                pausa = parada ? indiceDaSala(hall, parada) : SEM_INDICE;
+            }
+
+            // 5) Julgamento (ou a sessão fica guardada para depois)
+            if (pausa != SEM_INDICE) {
+                rc = salvarSessao(arqSalvar, &sessao, ht, pausa, &origem) == 0 ? 0 : 1;
+                if (rc == 0) escrever(saidaPadrao(), "\nSessão guardada em %s (continue com --retomar).\n",
+                                      arqSalvar);
+            } else {
+                verificarSuspeitoFinal(&sessao, ht, usarCenario ? &cenario : NULL);
+            }
+        }
+    }
+
+    descarregar(saidaPadrao());
+    if (mostrarMemoria) {
+        relatorioMemoria(stderr, "Sessão", &sessao.arena);
+        relatorioMemoria(stderr, "Mapa", &mapa);
+        relatorioMemoria(stderr, "Textos", &poolTextos.textos);
+        fprintf(stderr, "Textos internados: %u\n", numTextos());
+        fprintf(stderr, "Hash: %zu associações, %u pistas, %zu bytes + %zu de relações\n",
+                ht->ocupados, ht->numPistas, ht->capacidade * sizeof(uint32_t), ht->nos.bytesReservados);
+    }
+    if (formatoEstat) {
+        despejarEstatisticas(stderr, strcmp(formatoEstat, "json") == 0, ht, &mapa, &sessao);
+    }
+
+    // 6) Limpeza: cada estrutura sai com um único free da sua arena
+    //    (o rastro fecha antes do pool, de onde tira os textos)
+    liberarSessao(&sessao);
+    if (encerrarRastro() != 0) rc = 1;
+    liberarHash(ht);
+    arenaLiberar(&mapa);
+    liberarTextos();
+    if (usarCenario) fecharCenario(&cenario);
+
+    return rc;
+}
+
+#endif /* DETECTIVE_SEM_MAIN */
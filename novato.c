@@ -2,6 +2,47 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Arena: bloco contíguo de onde as salas são tiradas em sequência.
+// Toda a mansão é liberada com um único free no final.
+typedef struct Arena {
+    unsigned char* dados;
+    size_t usado;
+    size_t capacidade;
+} Arena;
+
+/**
+ * Função: criarArena
+ * ------------------
+ * Reserva um bloco com a capacidade pedida (em bytes).
+ */
+Arena criarArena(size_t capacidade) {
+    Arena a;
+    a.dados = (unsigned char*) malloc(capacidade);
+    if (a.dados == NULL) {
+        printf("Erro ao alocar memória!\n");
+        exit(1);
+    }
+    a.usado = 0;
+    a.capacidade = capacidade;
+    return a;
+}
+
+/**
+ * Função: alocarNaArena
+ * ---------------------
+ * Devolve o próximo pedaço livre do bloco (alinhado em 16 bytes).
+ */
+void* alocarNaArena(Arena* a, size_t tamanho) {
+    size_t pedido = (tamanho + 15) & ~(size_t) 15;
+    if (a->capacidade - a->usado < pedido) {
+        printf("Arena sem espaço!\n");
+        exit(1);
+    }
+    void* p = a->dados + a->usado;
+    a->usado += pedido;
+    return p;
+}
+
 // Estrutura que representa uma sala da mansão
 typedef struct Sala {
     char nome[50];
@@ -12,14 +53,10 @@ typedef struct Sala {
 /**
  * Função: criarSala
  * -----------------
- * Cria dinamicamente uma sala com um nome fornecido.
+ * Cria uma sala com o nome fornecido dentro da arena.
  */
-Sala* criarSala(const char* nome) {
-    Sala* novaSala = (Sala*) malloc(sizeof(Sala));
-    if (novaSala == NULL) {
-        printf("Erro ao alocar memória!\n");
-        exit(1);
-    }
+Sala* criarSala(Arena* arena, const char* nome) {
+    Sala* novaSala = (Sala*) alocarNaArena(arena, sizeof(Sala));
     strcpy(novaSala->nome, nome);
     novaSala->esquerda = NULL;
     novaSala->direita = NULL;
@@ -71,14 +108,15 @@ void explorarSalas(Sala* atual) {
  * e inicia a exploração pelo Hall de entrada.
  */
 int main() {
-    // Criando as salas (árvore fixa)
-    Sala* hall       = criarSala("Hall de Entrada");
-    Sala* salaEstar  = criarSala("Sala de Estar");
-    Sala* cozinha    = criarSala("Cozinha");
-    Sala* biblioteca = criarSala("Biblioteca");
-    Sala* jardim     = criarSala("Jardim");
-    Sala* quarto     = criarSala("Quarto");
-    Sala* adega      = criarSala("Adega");
+    // Criando as salas (árvore fixa) na arena
+    Arena arena = criarArena(7 * sizeof(Sala) + 7 * 16);
+    Sala* hall       = criarSala(&arena, "Hall de Entrada");
+    Sala* salaEstar  = criarSala(&arena, "Sala de Estar");
+    Sala* cozinha    = criarSala(&arena, "Cozinha");
+    Sala* biblioteca = criarSala(&arena, "Biblioteca");
+    Sala* jardim     = criarSala(&arena, "Jardim");
+    Sala* quarto     = criarSala(&arena, "Quarto");
+    Sala* adega      = criarSala(&arena, "Adega");
 
     // Montando a árvore manualmente
     hall->esquerda = salaEstar;
@@ -93,14 +131,8 @@ int main() {
     // Início da exploração
     explorarSalas(hall);
 
-    // Liberação da memória
-    free(hall);
-    free(salaEstar);
-    free(cozinha);
-    free(biblioteca);
-    free(jardim);
-    free(quarto);
-    free(adega);
+    // Liberação da memória: um único free para a mansão inteira
+    free(arena.dados);
 
     return 0;
 }